@@ -0,0 +1,72 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "arena.hpp"
+#include <algorithm>
+
+Arena::Arena(Arena &&other) noexcept
+    : blocks(std::move(other.blocks)), cursor(std::exchange(other.cursor, nullptr)),
+      limit(std::exchange(other.limit, nullptr)), nextBlockBytes(other.nextBlockBytes),
+      reservedBytes(std::exchange(other.reservedBytes, 0))
+{
+    other.blocks.clear();
+}
+
+Arena &Arena::operator=(Arena &&other) noexcept
+{
+    if (this != &other)
+    {
+        blocks = std::move(other.blocks);
+        other.blocks.clear();
+        cursor = std::exchange(other.cursor, nullptr);
+        limit = std::exchange(other.limit, nullptr);
+        nextBlockBytes = other.nextBlockBytes;
+        reservedBytes = std::exchange(other.reservedBytes, 0);
+    }
+    return *this;
+}
+
+void Arena::adopt(Arena &&other)
+{
+    blocks.reserve(blocks.size() + other.blocks.size());
+    for (std::unique_ptr<char[]> &block : other.blocks)
+    {
+        blocks.push_back(std::move(block));
+    }
+    reservedBytes += other.reservedBytes;
+
+    other.blocks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.reservedBytes = 0;
+}
+
+void *Arena::allocateSlow(size_t size, size_t align)
+{
+    // blocks double up to 1 MB so small parses stay small and large ones
+    // do not pay for thousands of allocations
+    size_t bytes = std::max(nextBlockBytes, size + align);
+    nextBlockBytes = std::min<size_t>(nextBlockBytes * 2, 1024 * 1024);
+
+    blocks.emplace_back(new char[bytes]);
+    cursor = blocks.back().get();
+    limit = cursor + bytes;
+    reservedBytes += bytes;
+
+    return allocate(size, align);
+}
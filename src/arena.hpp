@@ -0,0 +1,75 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump-pointer allocator. Objects are placed back to back in large blocks
+// and are never destroyed individually: the whole arena is released at
+// once, so anything made here must not own resources of its own.
+class Arena
+{
+public:
+    explicit Arena(size_t firstBlockBytes = 64 * 1024) : nextBlockBytes(firstBlockBytes) {}
+
+    // A moved-from arena is left empty, so it can not bump into blocks it
+    // no longer owns.
+    Arena(Arena &&other) noexcept;
+    Arena &operator=(Arena &&other) noexcept;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align)
+    {
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~(uintptr_t(align) - 1);
+        if (cursor != nullptr && aligned + size <= reinterpret_cast<uintptr_t>(limit))
+        {
+            cursor = reinterpret_cast<char *>(aligned + size);
+            return reinterpret_cast<void *>(aligned);
+        }
+        return allocateSlow(size, align);
+    }
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Takes over the blocks of `other`, whose objects then live as long as
+    // this arena. `other` is left empty.
+    void adopt(Arena &&other);
+
+    // bytes reserved from the system, including the unused tail of the current block
+    size_t capacity() const { return reservedBytes; }
+
+private:
+    void *allocateSlow(size_t size, size_t align);
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *cursor = nullptr;
+    char *limit = nullptr;
+    size_t nextBlockBytes;
+    size_t reservedBytes = 0;
+};
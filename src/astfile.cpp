@@ -0,0 +1,239 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "astfile.hpp"
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+template <typename T>
+static void appendRaw(std::string &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void serializeAST(const FlatAST &ast, std::string &out)
+{
+    // token texts are stored once each; a program repeats the same few
+    // names and operators over and over. Names are matched by their symbol,
+    // one integer compare, and only the other tokens hash their text.
+    std::unordered_map<Symbol, uint32_t> symbolIndex;
+    std::unordered_map<std::string_view, uint32_t> stringIndex;
+    std::vector<uint32_t> tokenStrings(ast.tokens.size());
+    std::vector<uint32_t> stringStarts{0};
+    std::vector<uint8_t> stringKinds;
+    std::string strings;
+    auto addString = [&](std::string_view text, uint8_t kind)
+    {
+        strings.append(text);
+        stringStarts.push_back(static_cast<uint32_t>(strings.size()));
+        stringKinds.push_back(kind);
+        return static_cast<uint32_t>(stringKinds.size() - 1);
+    };
+    for (size_t i = 0; i < ast.tokens.size(); i++)
+    {
+        std::string_view text = ast.tokens.text(i);
+        uint8_t kind = static_cast<uint8_t>(ast.tokens.kind(i));
+        Symbol symbol = ast.tokens.symbol(i);
+        if (symbol != NoSymbol)
+        {
+            auto inserted = symbolIndex.try_emplace(symbol, 0);
+            if (inserted.second)
+                inserted.first->second = addString(text, kind);
+            tokenStrings[i] = inserted.first->second;
+            continue;
+        }
+
+        auto found = stringIndex.find(text);
+        if (found == stringIndex.end() || stringKinds[found->second] != kind)
+        {
+            // a text seen with another kind gets an entry of its own
+            stringIndex[text] = tokenStrings[i] = addString(text, kind);
+        }
+        else
+        {
+            tokenStrings[i] = found->second;
+        }
+    }
+
+    ASTFileHeader header{};
+    std::memcpy(header.magic, "BAST", 4);
+    header.version = astFileVersion;
+    header.nodeCount = static_cast<uint32_t>(ast.nodes.size());
+    header.rootCount = static_cast<uint32_t>(ast.roots.size());
+    header.tokenCount = static_cast<uint32_t>(ast.tokens.size());
+    header.stringCount = static_cast<uint32_t>(stringStarts.size() - 1);
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    out.reserve(out.size() + sizeof(header) + ast.nodes.size() * sizeof(FlatNode) +
+                ast.roots.size() * sizeof(NodeIndex) + ast.tokens.size() * sizeof(ASTFileToken) +
+                stringStarts.size() * sizeof(uint32_t) + stringKinds.size() + strings.size());
+    appendRaw(out, header);
+
+    for (const FlatNode &node : ast.nodes)
+    {
+        // copied field by field so the padding after `kind` is zero
+        FlatNode clean;
+        std::memset(&clean, 0, sizeof(clean));
+        clean.kind = node.kind;
+        clean.token = node.token;
+        clean.first = node.first;
+        clean.second = node.second;
+        appendRaw(out, clean);
+    }
+    out.append(reinterpret_cast<const char *>(ast.roots.data()), ast.roots.size() * sizeof(NodeIndex));
+
+    for (size_t i = 0; i < ast.tokens.size(); i++)
+    {
+        appendRaw(out, ASTFileToken{tokenStrings[i], ast.tokens.offset(i)});
+    }
+
+    out.append(reinterpret_cast<const char *>(stringStarts.data()), stringStarts.size() * sizeof(uint32_t));
+    out.append(reinterpret_cast<const char *>(stringKinds.data()), stringKinds.size());
+    out.append(strings);
+}
+
+bool writeASTFile(const FlatAST &ast, const std::string &path)
+{
+    std::string bytes;
+    serializeAST(ast, bytes);
+    return writeASTFile(bytes, path);
+}
+
+bool writeASTFile(std::string_view bytes, const std::string &path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool ASTImage::load(const std::string &path)
+{
+    if (!mapping.map(path))
+        return false;
+    return open(mapping.view());
+}
+
+bool ASTImage::open(std::string_view bytes)
+{
+    header = nullptr;
+    if (bytes.size() < sizeof(ASTFileHeader) || reinterpret_cast<uintptr_t>(bytes.data()) % alignof(FlatNode) != 0)
+        return false;
+
+    const ASTFileHeader *candidate = reinterpret_cast<const ASTFileHeader *>(bytes.data());
+    if (std::memcmp(candidate->magic, "BAST", 4) != 0 || candidate->version != astFileVersion)
+        return false;
+
+    // section sizes in 64 bits, so counts near UINT32_MAX can not wrap
+    uint64_t nodeBytes = uint64_t(candidate->nodeCount) * sizeof(FlatNode);
+    uint64_t rootBytes = uint64_t(candidate->rootCount) * sizeof(NodeIndex);
+    uint64_t tokenBytes = uint64_t(candidate->tokenCount) * sizeof(ASTFileToken);
+    uint64_t startBytes = (uint64_t(candidate->stringCount) + 1) * sizeof(uint32_t);
+    uint64_t kindBytes = candidate->stringCount;
+    if (sizeof(ASTFileHeader) + nodeBytes + rootBytes + tokenBytes + startBytes + kindBytes + candidate->stringBytes !=
+        bytes.size())
+        return false;
+
+    const char *cursor = bytes.data() + sizeof(ASTFileHeader);
+    nodes = reinterpret_cast<const FlatNode *>(cursor);
+    cursor += nodeBytes;
+    rootList = reinterpret_cast<const NodeIndex *>(cursor);
+    cursor += rootBytes;
+    tokens = reinterpret_cast<const ASTFileToken *>(cursor);
+    cursor += tokenBytes;
+    stringStarts = reinterpret_cast<const uint32_t *>(cursor);
+    cursor += startBytes;
+    stringKinds = reinterpret_cast<const uint8_t *>(cursor);
+    cursor += kindBytes;
+    strings = cursor;
+
+    header = candidate;
+    if (!validate())
+    {
+        header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool ASTImage::validate() const
+{
+    if (stringStarts[0] != 0 || stringStarts[header->stringCount] != header->stringBytes)
+        return false;
+    for (uint32_t i = 0; i < header->stringCount; i++)
+    {
+        if (stringStarts[i] > stringStarts[i + 1] || stringKinds[i] > TK_EOF)
+            return false;
+    }
+
+    for (uint32_t i = 0; i < header->tokenCount; i++)
+    {
+        if (tokens[i].string >= header->stringCount)
+            return false;
+    }
+
+    // The nodes must form exactly the pre-order layout flattenAST writes:
+    // a node's first child directly follows it, its second child follows
+    // the first child's subtree, and the roots tile the whole array. Walking
+    // backwards, each node's subtree end is known by the time it is needed.
+    std::vector<NodeIndex> subtreeEnd(header->nodeCount);
+    for (NodeIndex i = header->nodeCount; i-- > 0;)
+    {
+        const FlatNode &node = nodes[i];
+        uint32_t tokensUsed;
+        switch (node.kind)
+        {
+        case FN_VarDeclaration:
+            tokensUsed = 2;
+            break;
+        case FN_ExprStmt:
+            tokensUsed = 0;
+            break;
+        case FN_Binary:
+        case FN_Unary:
+        case FN_Literal:
+        case FN_Identifier:
+            tokensUsed = 1;
+            break;
+        default:
+            return false;
+        }
+        if (tokensUsed > 0 && (node.token >= header->tokenCount || header->tokenCount - node.token < tokensUsed))
+            return false;
+
+        NodeIndex next = i + 1;
+        for (NodeIndex child : {node.first, node.second})
+        {
+            if (child == NoNode)
+                continue;
+            if (child != next || child >= header->nodeCount)
+                return false;
+            next = subtreeEnd[child];
+        }
+        subtreeEnd[i] = next;
+    }
+
+    NodeIndex next = 0;
+    for (uint32_t i = 0; i < header->rootCount; i++)
+    {
+        if (rootList[i] != next || next >= header->nodeCount)
+            return false;
+        next = subtreeEnd[next];
+    }
+    return next == header->nodeCount;
+}
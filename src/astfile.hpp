@@ -0,0 +1,107 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "flatast.hpp"
+#include "mappedfile.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Binary AST file, the FlatAST written out as-is so it can be used straight
+// from a memory mapping. Integers are in host byte order (a mismatching
+// reader sees a wrong version and rejects the file). Layout:
+//
+//     ASTFileHeader
+//     FlatNode      nodes[nodeCount]      pre-order, as in FlatAST
+//     NodeIndex     roots[rootCount]
+//     ASTFileToken  tokens[tokenCount]    the tokens nodes refer to
+//     uint32_t      stringStarts[stringCount + 1]
+//     uint8_t       stringKinds[stringCount]  TokenKind of each string
+//     char          strings[stringBytes]  every distinct token text once
+//
+// A token's kind follows from its text, so it is kept once per string
+// rather than per token. Every section before the byte-sized ones is a
+// multiple of 4 bytes long, so all of them are aligned in a mapping.
+constexpr uint32_t astFileVersion = 1;
+
+struct ASTFileHeader
+{
+    char magic[4]; // "BAST"
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t rootCount;
+    uint32_t tokenCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+struct ASTFileToken
+{
+    uint32_t string; // index into the string table
+    uint32_t offset; // byte offset in the source the AST was parsed from
+};
+
+static_assert(sizeof(ASTFileHeader) == 32 && sizeof(ASTFileToken) == 8, "the file layout is fixed");
+
+// Appends the binary form of `ast` to `out`.
+void serializeAST(const FlatAST &ast, std::string &out);
+
+bool writeASTFile(const FlatAST &ast, const std::string &path);
+bool writeASTFile(std::string_view bytes, const std::string &path);
+
+// Read-only view of a binary AST, either mapped from a file or over bytes
+// the caller keeps alive. Opening checks that the sections, indices and
+// tree shape are consistent; nodes and strings are then used in place.
+class ASTImage
+{
+public:
+    bool load(const std::string &path);
+    bool open(std::string_view bytes);
+
+    size_t nodeCount() const { return header->nodeCount; }
+    size_t rootCount() const { return header->rootCount; }
+    const NodeIndex *roots() const { return rootList; }
+
+    const FlatNode &operator[](NodeIndex index) const { return nodes[index]; }
+    std::string_view text(uint32_t token) const
+    {
+        uint32_t string = tokens[token].string;
+        return {strings + stringStarts[string], stringStarts[string + 1] - stringStarts[string]};
+    }
+    TokenKind kind(uint32_t token) const { return static_cast<TokenKind>(stringKinds[tokens[token].string]); }
+    uint32_t offset(uint32_t token) const { return tokens[token].offset; }
+
+private:
+    bool validate() const;
+
+    MappedFile mapping;
+    const ASTFileHeader *header = nullptr;
+    const FlatNode *nodes = nullptr;
+    const NodeIndex *rootList = nullptr;
+    const ASTFileToken *tokens = nullptr;
+    const uint32_t *stringStarts = nullptr;
+    const uint8_t *stringKinds = nullptr;
+    const char *strings = nullptr;
+};
+
+// Same output as printFlatAST on the FlatAST that was written.
+void printFlatAST(const ASTImage &image, std::ostream &out);
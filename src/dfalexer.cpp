@@ -0,0 +1,307 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+
+Table-driven lexer. Every byte is mapped to a character class, and the
+class indexes a row of the state transition matrix. The lexer runs until a
+byte has no transition and then emits the token of the last accepting state
+(maximal munch), so the inner loop is two table loads per byte with no
+branching on the character itself.
+
+Both tables are built by constexpr functions from the TokenKind enum in
+tokens.hpp and the operator table in lexertables.hpp. lexDFA() must produce
+exactly the same TokenBuffer as lex(), which `--lexer compare` checks.
+
+*/
+
+#include "lexer.hpp"
+#include "lexertables.hpp"
+
+enum DFAClass : uint8_t
+{
+    DC_Other,
+    DC_Space,
+    DC_Alpha, // letters and '_'
+    DC_Digit,
+    DC_Minus,
+    DC_Dot,
+    DC_SingleQuote,
+    DC_DoubleQuote,
+    DC_Backslash,
+    DC_Equals,
+    DC_Bang,
+    DC_Angle, // < >
+    DC_Amp,
+    DC_Pipe,
+    DC_Operator, // remaining single byte operators; the kind comes from operatorTable
+
+    DC_Count
+};
+
+enum DFAState : uint8_t
+{
+    DS_Start,
+    DS_Whitespace,
+    DS_Identifier,
+    DS_Minus,
+    DS_Integer,
+    DS_Float,
+    DS_CharOpen,   // '
+    DS_CharEscape, // '\ .
+    DS_CharBody,   // 'x  or  '\x
+    DS_StringBody,
+    DS_StringEscape,
+    DS_Equals,
+    DS_Bang,
+    DS_Angle,
+    DS_Amp,
+    DS_Pipe,
+    DS_Operator, // + * / % ; ( ) { } ,
+    DS_Skip,     // a byte that starts no token
+
+    // one terminal state per TokenKind, reached when a token can not grow
+    DS_Final,
+
+    DS_Dead = 0xFF
+};
+
+constexpr size_t dfaStateCount = DS_Final + TK_EOF + 1;
+
+constexpr uint8_t finalState(TokenKind kind)
+{
+    return static_cast<uint8_t>(DS_Final + kind);
+}
+
+enum DFAAcceptFlags : uint8_t
+{
+    DA_Accept = 1 << 0,
+    DA_Emit = 1 << 1,        // otherwise the match is skipped (whitespace, unknown bytes)
+    DA_Keyword = 1 << 2,     // resolve identifiers through the keyword table
+    DA_DropMinus = 1 << 3,   // negative numbers start after their '-'
+    DA_OperatorKind = 1 << 4 // the kind is operatorTable[first byte].single
+};
+
+struct DFAAccept
+{
+    uint8_t flags = 0;
+    TokenKind kind = TK_Unknown;
+};
+
+struct DFATables
+{
+    std::array<uint8_t, 256> classes{};
+    std::array<std::array<uint8_t, DC_Count>, dfaStateCount> transitions{};
+    std::array<DFAAccept, dfaStateCount> accepts{};
+};
+
+constexpr DFATables buildDFATables()
+{
+    DFATables t{};
+
+    for (int c = 0; c < 256; c++)
+    {
+        uint8_t cls = DC_Other;
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+            cls = DC_Space;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+            cls = DC_Alpha;
+        else if (c >= '0' && c <= '9')
+            cls = DC_Digit;
+        else if (c == '-')
+            cls = DC_Minus;
+        else if (c == '.')
+            cls = DC_Dot;
+        else if (c == '\'')
+            cls = DC_SingleQuote;
+        else if (c == '"')
+            cls = DC_DoubleQuote;
+        else if (c == '\\')
+            cls = DC_Backslash;
+        else if (c == '=')
+            cls = DC_Equals;
+        else if (c == '!')
+            cls = DC_Bang;
+        else if (c == '<' || c == '>')
+            cls = DC_Angle;
+        else if (c == '&')
+            cls = DC_Amp;
+        else if (c == '|')
+            cls = DC_Pipe;
+        else if (operatorTable[c].single != TK_Unknown)
+            cls = DC_Operator;
+        t.classes[c] = cls;
+    }
+
+    for (auto &row : t.transitions)
+    {
+        for (auto &next : row)
+        {
+            next = DS_Dead;
+        }
+    }
+
+    auto set = [&t](uint8_t state, uint8_t cls, uint8_t next)
+    { t.transitions[state][cls] = next; };
+    auto setAll = [&t](uint8_t state, uint8_t next)
+    {
+        for (auto &cell : t.transitions[state])
+            cell = next;
+    };
+
+    // start
+    set(DS_Start, DC_Other, DS_Skip);
+    set(DS_Start, DC_Digit, DS_Skip);
+    set(DS_Start, DC_Dot, DS_Skip);
+    set(DS_Start, DC_Backslash, DS_Skip);
+    set(DS_Start, DC_Space, DS_Whitespace);
+    set(DS_Start, DC_Alpha, DS_Identifier);
+    set(DS_Start, DC_Minus, DS_Minus);
+    set(DS_Start, DC_SingleQuote, DS_CharOpen);
+    set(DS_Start, DC_DoubleQuote, DS_StringBody);
+    set(DS_Start, DC_Equals, DS_Equals);
+    set(DS_Start, DC_Bang, DS_Bang);
+    set(DS_Start, DC_Angle, DS_Angle);
+    set(DS_Start, DC_Amp, DS_Amp);
+    set(DS_Start, DC_Pipe, DS_Pipe);
+    set(DS_Start, DC_Operator, DS_Operator);
+
+    set(DS_Whitespace, DC_Space, DS_Whitespace);
+
+    set(DS_Identifier, DC_Alpha, DS_Identifier);
+    set(DS_Identifier, DC_Digit, DS_Identifier);
+
+    // numbers only exist behind a '-'; a second '.' ends the number
+    set(DS_Minus, DC_Digit, DS_Integer);
+    set(DS_Integer, DC_Digit, DS_Integer);
+    set(DS_Integer, DC_Dot, DS_Float);
+    set(DS_Float, DC_Digit, DS_Float);
+
+    setAll(DS_CharOpen, DS_CharBody);
+    set(DS_CharOpen, DC_Backslash, DS_CharEscape);
+    set(DS_CharOpen, DC_SingleQuote, finalState(TK_String));
+    setAll(DS_CharEscape, DS_CharBody);
+    set(DS_CharEscape, DC_SingleQuote, finalState(TK_String));
+    set(DS_CharBody, DC_SingleQuote, finalState(TK_String));
+
+    setAll(DS_StringBody, DS_StringBody);
+    set(DS_StringBody, DC_Backslash, DS_StringEscape);
+    set(DS_StringBody, DC_DoubleQuote, finalState(TK_String));
+    setAll(DS_StringEscape, DS_StringBody);
+
+    set(DS_Equals, DC_Equals, finalState(TK_ComparisonOperator));
+    set(DS_Bang, DC_Equals, finalState(TK_ComparisonOperator));
+    set(DS_Angle, DC_Equals, finalState(TK_ComparisonOperator));
+    set(DS_Amp, DC_Amp, finalState(TK_LogicalOperator));
+    set(DS_Pipe, DC_Pipe, finalState(TK_LogicalOperator));
+
+    auto accept = [&t](uint8_t state, uint8_t flags, TokenKind kind)
+    { t.accepts[state] = {static_cast<uint8_t>(flags | DA_Accept), kind}; };
+
+    accept(DS_Skip, 0, TK_Unknown);
+    accept(DS_Whitespace, 0, TK_Unknown);
+    accept(DS_Identifier, DA_Emit | DA_Keyword, TK_Identifier);
+    accept(DS_Minus, DA_Emit, TK_MathOperator);
+    accept(DS_Integer, DA_Emit | DA_DropMinus, TK_Integer);
+    accept(DS_Float, DA_Emit | DA_DropMinus, TK_Float);
+    accept(DS_CharOpen, DA_Emit, TK_String);
+    accept(DS_CharEscape, DA_Emit, TK_String);
+    accept(DS_CharBody, DA_Emit, TK_String);
+    accept(DS_StringBody, DA_Emit, TK_String);
+    accept(DS_StringEscape, DA_Emit, TK_String);
+    accept(DS_Equals, DA_Emit, TK_EqualsSign);
+    accept(DS_Bang, DA_Emit, TK_LogicalOperator);
+    accept(DS_Angle, DA_Emit, TK_ComparisonOperator);
+    accept(DS_Operator, DA_Emit | DA_OperatorKind, TK_Unknown);
+    // DS_Amp and DS_Pipe do not accept: a lone '&' or '|' is skipped
+
+    for (int kind = 0; kind <= TK_EOF; kind++)
+    {
+        accept(finalState(static_cast<TokenKind>(kind)), DA_Emit, static_cast<TokenKind>(kind));
+    }
+
+    return t;
+}
+
+static constexpr DFATables dfaTables = buildDFATables();
+
+TokenBuffer lexDFA(const SourceFile &source)
+{
+    std::string_view input = source.text();
+    TokenBuffer tokens(input);
+    const auto &classes = dfaTables.classes;
+    const auto &transitions = dfaTables.transitions;
+    const auto &accepts = dfaTables.accepts;
+    StringInterner &interner = symbolTable();
+
+    const size_t end = input.size();
+    size_t pos = 0;
+
+    while (pos < end)
+    {
+        size_t start = pos;
+        size_t acceptEnd = 0;
+        uint8_t acceptState = DS_Dead;
+        uint8_t state = DS_Start;
+
+        while (pos < end)
+        {
+            uint8_t cls = classes[static_cast<unsigned char>(input[pos])];
+            uint8_t next = transitions[state][cls];
+            if (next == DS_Dead)
+                break;
+
+            state = next;
+            pos++;
+
+            if (accepts[state].flags & DA_Accept)
+            {
+                acceptState = state;
+                acceptEnd = pos;
+            }
+        }
+
+        if (acceptState == DS_Dead)
+        {
+            // only a lone '&' or '|' gets here; it is skipped like any unknown byte
+            pos = start + 1;
+            continue;
+        }
+
+        // roll back anything read past the last accepting state
+        pos = acceptEnd;
+
+        const DFAAccept &accept = accepts[acceptState];
+        if (!(accept.flags & DA_Emit))
+            continue;
+
+        TokenKind kind = accept.kind;
+        if (accept.flags & DA_DropMinus)
+            start++;
+        if (accept.flags & DA_Keyword)
+            kind = lookupKeyword(input.substr(start, pos - start));
+        if (accept.flags & DA_OperatorKind)
+            kind = operatorTable[static_cast<unsigned char>(input[start])].single;
+
+        Symbol symbol = isInternedKind(kind) ? interner.intern(input.substr(start, pos - start)) : NoSymbol;
+        tokens.push(kind, static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start), symbol);
+    }
+
+    tokens.push(TK_EOF, static_cast<uint32_t>(end), 0);
+    return tokens;
+}
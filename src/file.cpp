@@ -15,8 +15,12 @@ Copyright 2025-latest I. Mitterfellner
 */
 
 #include "file.hpp"
+#include "unicode.hpp"
+#include "tokens.hpp"
+#include "log.hpp"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <system_error>
@@ -113,21 +117,10 @@ int checkFileAccess(const std::filesystem::path &path, int amode)
     }
 }
 
-FileType detectFileType(const std::string &filename)
+FileType detectFileType(std::string_view content)
 {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file)
-        return FileType::UNKNOWN;
-
-    // first 4 bytes to check for BOM
-    std::vector<uint8_t> header(4);
-    if (!file.read(reinterpret_cast<char *>(header.data()), 4))
-    {
-        // no 4 bytes reset
-        file.clear();
-        file.seekg(0);
-    }
-    size_t bytes_read = file.gcount();
+    const uint8_t *header = reinterpret_cast<const uint8_t *>(content.data());
+    size_t bytes_read = std::min<size_t>(content.size(), 4);
 
     // BOM markers
     if (bytes_read >= 2)
@@ -147,73 +140,79 @@ FileType detectFileType(const std::string &filename)
             return FileType::TEXT_UTF16_BE;
         }
     }
-    if (bytes_read >= 3 && header[0] == 0xEF && header[1] == 0xBB && header[2] == 0xBF)
-    {
-        return FileType::TEXT_UTF8;
-    }
     if (bytes_read >= 4 && header[0] == 0x00 && header[1] == 0x00 &&
         header[2] == 0xFE && header[3] == 0xFF)
     {
         return FileType::TEXT_UTF32_BE;
     }
 
-    // no BOM found so check content
-    file.seekg(0);
-    bool has_null = false;
-    bool is_ascii = true;
-    bool is_utf8 = true;
-    size_t utf8_continuation = 0;
-    const size_t max_bytes_to_check = 4096;
-    size_t total_bytes = 0;
-
-    uint8_t byte;
-    while (total_bytes < max_bytes_to_check && file.read(reinterpret_cast<char *>(&byte), 1))
+    // a NUL in the head marks a binary file even though it is valid UTF-8
+    const size_t sample_size = std::min<size_t>(content.size(), 4096);
+    if (std::memchr(content.data(), 0x00, sample_size) != nullptr)
+        return FileType::BINARY;
+
+    // covers a UTF-8 BOM too; convertToUTF8 strips it
+    return validateUTF8(content) ? FileType::TEXT_UTF8 : FileType::BINARY;
+}
+
+fileStruct readStream(const std::filesystem::path &path)
+{
+    std::ifstream inputStream(path, std::ios::binary);
+    if (!inputStream)
+        return {false, ""};
+
+    std::string content;
+    std::vector<char> block(64 * 1024);
+    while (inputStream.read(block.data(), block.size()) || inputStream.gcount() > 0)
     {
-        total_bytes++;
+        content.append(block.data(), static_cast<size_t>(inputStream.gcount()));
+    }
 
-        // null byte
-        if (byte == 0x00)
-            has_null = true;
+    if (inputStream.bad())
+        return {false, ""};
+    return {true, std::move(content)};
+}
 
-        // non-ASCII
-        if (byte > 127)
-            is_ascii = false;
+// Leaves every accepted input as validated UTF-8 without a byte order mark.
+// Wide encodings are transcoded into fileContent, which then replaces the
+// mapping.
+static bool convertToUTF8(fileStruct &file, FileType type)
+{
+    std::string_view content = file.fileMapping.isMapped() ? file.fileMapping.view() : std::string_view(file.fileContent);
+    std::string utf8;
 
-        // UTF8 sequences
-        if (utf8_continuation > 0)
-        {
-            if ((byte & 0xC0) != 0x80)
-                is_utf8 = false;
-            utf8_continuation--;
-        }
-        else if (byte > 127)
+    switch (type)
+    {
+    case FileType::TEXT_UTF16_LE:
+    case FileType::TEXT_UTF16_BE:
+        if (!transcodeUTF16ToUTF8(content, type == FileType::TEXT_UTF16_BE, utf8))
+            return false;
+        break;
+    case FileType::TEXT_UTF32_LE:
+    case FileType::TEXT_UTF32_BE:
+        if (!transcodeUTF32ToUTF8(content, type == FileType::TEXT_UTF32_BE, utf8))
+            return false;
+        break;
+    default:
+        // detectFileType already validated it
+        if (content.substr(0, 3) == "\xEF\xBB\xBF")
         {
-            if ((byte & 0xE0) == 0xC0)
-                utf8_continuation = 1;
-            else if ((byte & 0xF0) == 0xE0)
-                utf8_continuation = 2;
-            else if ((byte & 0xF8) == 0xF0)
-                utf8_continuation = 3;
+            if (file.fileMapping.isMapped())
+                file.fileMapping.skipPrefix(3);
             else
-                is_utf8 = false;
+                file.fileContent.erase(0, 3);
         }
+        return true;
     }
 
-    if (utf8_continuation > 0)
-        is_utf8 = false;
-
-    if (has_null)
-        return FileType::BINARY;
-    if (is_ascii)
-        return FileType::TEXT_ASCII;
-    if (is_utf8)
-        return FileType::TEXT_UTF8;
-    return FileType::BINARY;
+    file.fileContent = std::move(utf8);
+    file.fileMapping = MappedFile();
+    return true;
 }
 
 fileStruct readFile(std::string absoluteReadPath)
 {
-    std::cout << absoluteReadPath << std::endl;
+    BASL_LOG_DEBUG("Reading " << absoluteReadPath);
 
     std::string absPath = normalizePath(pathToAbsolutePath(absoluteReadPath));
     if (absPath.empty())
@@ -222,50 +221,62 @@ fileStruct readFile(std::string absoluteReadPath)
         return {false, ""};
     }
 
+    // one stat answers existence, type and permissions
     std::error_code ec;
     std::filesystem::path path(absPath);
+    std::filesystem::file_status status = std::filesystem::status(path, ec);
 
-    if (!std::filesystem::exists(path, ec) || ec)
+    if (ec || !std::filesystem::exists(status) || std::filesystem::is_directory(status))
         return {false, ""};
-    if (!std::filesystem::is_regular_file(path, ec) || ec)
+    if ((status.permissions() & std::filesystem::perms::owner_read) == std::filesystem::perms::none)
         return {false, ""};
-    if (checkFileAccess(path, READ_OK) != 0)
-        return {false, ""};
-    ;
 
-    FileType type = detectFileType(absoluteReadPath);
-    if (type == FileType::UNKNOWN || type == FileType::BINARY)
+    bool regular = std::filesystem::is_regular_file(status);
+    uintmax_t size = regular ? std::filesystem::file_size(path, ec) : 0;
+    if (ec)
+        return {false, ""};
+    if (size > maxSourceBytes)
     {
+        std::cerr << "Input larger than 4 GiB: " << absPath << std::endl;
         return {false, ""};
     }
+    // an empty file is valid, empty source; there is nothing to open
+    if (regular && size == 0)
+        return {true, ""};
+
+    // The file is opened exactly once. Pipes and character devices can not
+    // be mapped, so those are read block by block.
+    fileStruct result{true, ""};
+    if (!regular || !result.fileMapping.map(absPath))
+    {
+        result = readStream(path);
+        if (!result.fileReadSuccess)
+            return result;
+    }
 
-    std::ifstream inputFileStream(path, std::ios::binary);
-    if (!inputFileStream)
+    std::string_view content = result.fileMapping.isMapped() ? result.fileMapping.view() : std::string_view(result.fileContent);
+    FileType type = detectFileType(content);
+    if (type == FileType::UNKNOWN || type == FileType::BINARY)
+    {
+        std::cerr << "Invalid text encoding in: " << absPath << std::endl;
         return {false, ""};
+    }
 
-    std::string content;
-    try
+    if (!convertToUTF8(result, type))
     {
-        inputFileStream.seekg(0, std::ios::end);
-        auto size = inputFileStream.tellg();
-        if (size == -1)
-            return {false, ""};
-
-        content.resize(static_cast<size_t>(size));
-        inputFileStream.seekg(0);
-        inputFileStream.read(&content[0], size);
-
-        if (!inputFileStream && !inputFileStream.eof())
-        {
-            return {false, ""};
-        }
+        std::cerr << "Invalid text encoding in: " << absPath << std::endl;
+        return {false, ""};
     }
-    catch (const std::exception &)
+
+    // pipes are only measured once read, and transcoding can grow the text
+    content = result.fileMapping.isMapped() ? result.fileMapping.view() : std::string_view(result.fileContent);
+    if (content.size() > maxSourceBytes)
     {
+        std::cerr << "Input larger than 4 GiB: " << absPath << std::endl;
         return {false, ""};
     }
 
-    return {true, content};
+    return result;
 }
 
 std::string pathToAbsolutePath(std::string pathStr)
@@ -280,16 +291,16 @@ std::string pathToAbsolutePath(std::string pathStr)
     try
     {
         std::filesystem::path pathObj(pathStr);
-        std::cerr << "Original path: " << pathStr << std::endl;
+        BASL_LOG_DEBUG("Original path: " << pathStr);
 
         if (!pathObj.is_absolute())
         {
             std::filesystem::path absolute = std::filesystem::absolute(pathObj);
-            std::cerr << "Converted to absolute: " << absolute << std::endl;
+            BASL_LOG_DEBUG("Converted to absolute: " << absolute);
             return absolute.generic_string();
         }
 
-        std::cerr << "Already absolute: " << pathObj << std::endl;
+        BASL_LOG_DEBUG("Already absolute: " << pathObj);
         return pathObj.generic_string();
     }
     catch (const std::exception &e)
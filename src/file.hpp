@@ -18,9 +18,11 @@ Copyright 2025-latest I. Mitterfellner
 
 #pragma once
 
+#include "mappedfile.hpp"
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <cctype>
 #include <vector>
 #include <cstdint>
@@ -45,12 +47,19 @@ enum class FileType
 
 struct fileStruct
 {
-    bool fileReadSuccess;
-    std::string fileContent;
+    bool fileReadSuccess = false;
+    std::string fileContent{}; // filled when the file could not be mapped
+    MappedFile fileMapping{};
 };
 
 int checkFileAccess(const std::filesystem::path &path, int amode);
 
+// Classifies already loaded file contents by BOM. Without a wide BOM the
+// first 4 KB are checked for NUL bytes and the whole buffer is validated
+// as UTF-8 in one SIMD pass; anything else is BINARY. A TEXT_UTF8 result
+// is therefore already known to be valid.
+FileType detectFileType(std::string_view content);
+
 fileStruct readFile(std::string absoluteReadPath = "");
 
 std::string pathToAbsolutePath(std::string pathStr);    
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "flatast.hpp"
+#include "astfile.hpp"
+
+// Lays nodes out in pre-order without recursing: visiting a node reserves
+// its slot and defers its children, first child on top, so a subtree is
+// finished before its next sibling starts. Depth costs heap, not stack.
+class Flattener : public ASTVisitor<Flattener, NodeIndex>
+{
+public:
+    explicit Flattener(FlatAST &ast) : ast(ast) {}
+
+    NodeIndex flatten(const Stmt *stmt)
+    {
+        NodeIndex root = visit(stmt);
+        while (!pending.empty())
+        {
+            Pending child = pending.back();
+            pending.pop_back();
+            NodeIndex index = visit(child.expr);
+            if (child.second)
+                ast.nodes[child.parent].second = index;
+            else
+                ast.nodes[child.parent].first = index;
+        }
+        return root;
+    }
+
+    NodeIndex visitVarDeclaration(const VarDeclaration *varDecl)
+    {
+        NodeIndex index = reserve(FN_VarDeclaration, token(varDecl->type));
+        token(varDecl->name);
+        if (varDecl->initializer)
+            pending.push_back({varDecl->initializer, index, false});
+        return index;
+    }
+
+    NodeIndex visitExprStmt(const ExprStmt *exprStmt)
+    {
+        NodeIndex index = reserve(FN_ExprStmt, 0);
+        if (exprStmt->expr)
+            pending.push_back({exprStmt->expr, index, false});
+        return index;
+    }
+
+    NodeIndex visitBinary(const BinaryExpr *binary)
+    {
+        NodeIndex index = reserve(FN_Binary, token(binary->op));
+        pending.push_back({binary->right, index, true});
+        pending.push_back({binary->left, index, false});
+        return index;
+    }
+
+    NodeIndex visitUnary(const UnaryExpr *unary)
+    {
+        NodeIndex index = reserve(FN_Unary, token(unary->op));
+        pending.push_back({unary->right, index, false});
+        return index;
+    }
+
+    NodeIndex visitLiteral(const Literal *literal) { return reserve(FN_Literal, token(literal->value)); }
+    NodeIndex visitIdentifier(const Identifier *ident) { return reserve(FN_Identifier, token(ident->name)); }
+    NodeIndex visitNull() { return NoNode; }
+
+private:
+    struct Pending
+    {
+        const Expr *expr;
+        NodeIndex parent;
+        bool second; // which child slot of `parent` it fills
+    };
+
+    NodeIndex reserve(FlatNodeKind kind, uint32_t token)
+    {
+        ast.nodes.push_back({kind, token, NoNode, NoNode});
+        return static_cast<NodeIndex>(ast.nodes.size() - 1);
+    }
+
+    uint32_t token(const Token &token)
+    {
+        ast.tokens.push(token.type, token.offset, static_cast<uint32_t>(token.value.size()), token.symbol);
+        return static_cast<uint32_t>(ast.tokens.size() - 1);
+    }
+
+    FlatAST &ast;
+    std::vector<Pending> pending;
+};
+
+FlatAST flattenAST(const ParseResult &result, std::string_view source)
+{
+    FlatAST ast(source);
+    Flattener flattener(ast);
+    for (const Stmt *stmt : result.statements)
+    {
+        NodeIndex root = flattener.flatten(stmt);
+        if (root != NoNode)
+            ast.roots.push_back(root);
+    }
+    return ast;
+}
+
+// Shared by FlatAST and ASTImage, which index nodes and token texts alike.
+// Nodes come in pre-order, so they are printed as they are read; `open`
+// holds the operators whose closing parenthesis is still due, which keeps
+// arbitrarily deep expressions off the call stack.
+template <typename AST>
+static void printExpr(OutputSink &out, const AST &ast, NodeIndex index, int level)
+{
+    struct Open
+    {
+        NodeIndex children[2];
+        int count;
+        int next;
+        int level;
+    };
+    std::vector<Open> open;
+
+    for (;;)
+    {
+        const FlatNode *node = index == NoNode ? nullptr : &ast[index];
+        if (node && (node->kind == FN_Binary || node->kind == FN_Unary))
+        {
+            out << '(' << ast.text(node->token);
+            int count = node->kind == FN_Binary ? 2 : node->first != NoNode ? 1 : 0;
+            open.push_back({{node->first, node->second}, count, 0, level});
+        }
+        else if (node && node->kind == FN_Literal)
+            out << "(literal " << ast.text(node->token) << ')';
+        else if (node && node->kind == FN_Identifier)
+            out << "(id " << ast.text(node->token) << ')';
+        else
+            out << "(unknown_expr)";
+
+        // close every operator that has printed all of its operands, then
+        // start on the next operand, if any is left
+        while (!open.empty() && open.back().next == open.back().count)
+        {
+            out << ')';
+            open.pop_back();
+        }
+        if (open.empty())
+            return;
+
+        Open &parent = open.back();
+        level = parent.level + 1;
+        index = parent.children[parent.next++];
+        out << '\n';
+        out.indent(level);
+    }
+}
+
+template <typename AST>
+static void printRoots(std::ostream &stream, const AST &ast, const NodeIndex *roots, size_t rootCount)
+{
+    OutputSink out(stream);
+    out << "Abstract Syntax Tree:\n";
+    for (const NodeIndex *root = roots; root != roots + rootCount; ++root)
+    {
+        const FlatNode &node = ast[*root];
+        if (node.kind == FN_VarDeclaration)
+        {
+            out << "VarDeclaration: " << ast.text(node.token) << ' ' << ast.text(node.token + 1);
+            if (node.first != NoNode)
+            {
+                out << '\n';
+                out.indent(1);
+                out << "Initializer: ";
+                printExpr(out, ast, node.first, 1);
+            }
+        }
+        else if (node.kind == FN_ExprStmt)
+        {
+            out << "ExpressionStatement:";
+            if (node.first != NoNode)
+            {
+                out << '\n';
+                out.indent(1);
+                printExpr(out, ast, node.first, 1);
+            }
+        }
+        out << '\n';
+    }
+}
+
+void printFlatAST(const FlatAST &ast, std::ostream &out)
+{
+    printRoots(out, ast, ast.roots.data(), ast.roots.size());
+}
+
+void printFlatAST(const ASTImage &image, std::ostream &out)
+{
+    printRoots(out, image, image.roots(), image.rootCount());
+}
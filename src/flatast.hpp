@@ -0,0 +1,73 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "parser.hpp"
+#include "tokens.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum FlatNodeKind : uint8_t
+{
+    FN_VarDeclaration, // token: type (the name is token + 1), first: initializer or NoNode
+    FN_ExprStmt,       // first: expression
+    FN_Binary,         // token: operator, first: left, second: right
+    FN_Unary,          // token: operator, first: operand
+    FN_Literal,        // token: value
+    FN_Identifier,     // token: name
+};
+
+using NodeIndex = uint32_t;
+constexpr NodeIndex NoNode = UINT32_MAX;
+
+struct FlatNode
+{
+    FlatNodeKind kind;
+    uint32_t token;
+    NodeIndex first;
+    NodeIndex second;
+};
+
+static_assert(sizeof(FlatNode) == 16, "FlatNode should stay four words");
+
+// The AST as one vector of fixed-size nodes. Children are 32-bit indices
+// and every node comes after its parent (pre-order), so a whole-tree walk
+// reads `nodes` front to back. Node payloads are indices into `tokens`,
+// which holds only the tokens the tree refers to. Nothing in here is a
+// pointer, so the structure can be copied or written out as-is.
+struct FlatAST
+{
+    explicit FlatAST(std::string_view source) : tokens(source) {}
+
+    std::vector<FlatNode> nodes;
+    std::vector<NodeIndex> roots;
+    TokenBuffer tokens;
+
+    const FlatNode &operator[](NodeIndex index) const { return nodes[index]; }
+    std::string_view text(uint32_t token) const { return tokens.text(token); }
+};
+
+// Lays the tree of `result` out flat. `source` is the text its tokens view.
+FlatAST flattenAST(const ParseResult &result, std::string_view source);
+
+// Same output as Parser::printAST.
+void printFlatAST(const FlatAST &ast, std::ostream &out);
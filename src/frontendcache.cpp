@@ -0,0 +1,323 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "frontendcache.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// Entry file layout, after the Header:
+//     char     ast[astBytes]          a binary AST file, see astfile.hpp
+//     char     diagnostics[diagnosticBytes]
+// The header keeps the AST 8-byte aligned.
+static constexpr uint32_t cacheEntryVersion = 1;
+
+static_assert(sizeof(CacheEntry::Header) == 40, "the entry layout is fixed");
+
+static constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+
+static inline uint64_t rotateLeft(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t hashRound(uint64_t lane, uint64_t word)
+{
+    return rotateLeft(lane + word * prime2, 31) * prime1;
+}
+
+static inline uint64_t avalanche(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    return hash ^ (hash >> 32);
+}
+
+ContentHash hashContent(std::string_view bytes, uint64_t seed)
+{
+    const char *data = bytes.data();
+    size_t size = bytes.size();
+    uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+
+    for (; size >= 32; data += 32, size -= 32)
+    {
+        uint64_t words[4];
+        std::memcpy(words, data, 32);
+        lanes[0] = hashRound(lanes[0], words[0]);
+        lanes[1] = hashRound(lanes[1], words[1]);
+        lanes[2] = hashRound(lanes[2], words[2]);
+        lanes[3] = hashRound(lanes[3], words[3]);
+    }
+
+    // the last partial stripe goes through the lanes zero-padded; the
+    // total length is mixed in below, so padding can not collide
+    if (size > 0)
+    {
+        uint64_t words[4] = {};
+        std::memcpy(words, data, size);
+        for (int i = 0; i < 4; i++)
+            lanes[i] = hashRound(lanes[i], words[i]);
+    }
+
+    uint64_t length = bytes.size();
+    uint64_t low = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+    uint64_t high = (lanes[0] * prime3) ^ rotateLeft(lanes[1] * prime4, 17) ^ rotateLeft(lanes[2] * prime1, 29) ^
+                    rotateLeft(lanes[3] * prime2, 43);
+    return {avalanche(high + length * prime4), avalanche(low ^ length)};
+}
+
+std::string ContentHash::hex() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; i++)
+    {
+        text[15 - i] = digits[(high >> (i * 4)) & 15];
+        text[31 - i] = digits[(low >> (i * 4)) & 15];
+    }
+    return text;
+}
+
+ContentHash frontEndCacheKey(std::string_view bytes, std::string_view version)
+{
+    return hashContent(bytes, hashContent(version).low);
+}
+
+bool CacheEntry::load(const std::string &path, const ContentHash &key)
+{
+    header = nullptr;
+    if (!mapping.map(path))
+        return false;
+
+    std::string_view bytes = mapping.view();
+    if (bytes.size() < sizeof(Header))
+        return false;
+    const Header *candidate = reinterpret_cast<const Header *>(bytes.data());
+    if (std::memcmp(candidate->magic, "BFEC", 4) != 0 || candidate->version != cacheEntryVersion ||
+        candidate->keyHigh != key.high || candidate->keyLow != key.low)
+        return false;
+
+    uint64_t payload = bytes.size() - sizeof(Header);
+    if (candidate->astBytes > payload || candidate->diagnosticBytes != payload - candidate->astBytes)
+        return false;
+
+    const char *cursor = bytes.data() + sizeof(Header);
+    astData = std::string_view(cursor, candidate->astBytes);
+    diagnosticText = std::string_view(cursor + candidate->astBytes, candidate->diagnosticBytes);
+
+    if (!image.open(astData))
+        return false;
+    header = candidate;
+    return true;
+}
+
+FrontEndCache::FrontEndCache(std::string directory, uint64_t sizeLimit)
+    : directory(std::move(directory)), sizeLimit(sizeLimit)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(this->directory, ec);
+}
+
+std::string FrontEndCache::entryPath(const ContentHash &key) const
+{
+    return (std::filesystem::path(directory) / (key.hex() + ".bfc")).string();
+}
+
+bool FrontEndCache::lookup(const ContentHash &key, CacheEntry &entry)
+{
+    std::string path = entryPath(key);
+    if (!entry.load(path, key))
+    {
+        BASL_LOG_INFO("[Cache] Miss " << key.hex());
+        addStats(0, 1, 0);
+        return false;
+    }
+
+    BASL_LOG_INFO("[Cache] Hit " << key.hex());
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    addStats(1, 0, 0);
+    return true;
+}
+
+// Temporary files are named `<target>.tmp<random>`. One that is older than
+// this was left behind by a run that died before renaming it.
+static constexpr std::chrono::minutes staleTemporaryAge{10};
+
+// Writes `bytes` aside and renames them over `path`, so a reader only ever
+// sees the old or the new file whole.
+static bool replaceFile(const std::string &path, std::string_view bytes)
+{
+    std::string temporary = path + ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+        {
+            std::error_code ec;
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, path, ec);
+    if (ec)
+    {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+static bool isTemporaryFile(const std::filesystem::path &path)
+{
+    return path.filename().string().find(".tmp") != std::string::npos;
+}
+
+bool FrontEndCache::store(const ContentHash &key, const FlatAST &ast, std::string_view diagnostics)
+{
+    std::string astBytes;
+    serializeAST(ast, astBytes);
+
+    CacheEntry::Header header{};
+    std::memcpy(header.magic, "BFEC", 4);
+    header.version = cacheEntryVersion;
+    header.keyHigh = key.high;
+    header.keyLow = key.low;
+    header.astBytes = astBytes.size();
+    header.diagnosticBytes = diagnostics.size();
+
+    std::string bytes;
+    bytes.reserve(sizeof(header) + astBytes.size() + diagnostics.size());
+    bytes.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    bytes.append(astBytes);
+    bytes.append(diagnostics);
+
+    if (!replaceFile(entryPath(key), bytes))
+        return false;
+
+    evict();
+    return true;
+}
+
+void FrontEndCache::evict()
+{
+    struct Item
+    {
+        std::filesystem::file_time_type used;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+
+    std::vector<Item> items;
+    uint64_t total = 0;
+    std::error_code ec;
+    std::filesystem::file_time_type staleBefore = std::filesystem::file_time_type::clock::now() - staleTemporaryAge;
+    for (const std::filesystem::directory_entry &file : std::filesystem::directory_iterator(directory, ec))
+    {
+        std::error_code itemError;
+        if (isTemporaryFile(file.path()))
+        {
+            // a fresh one may still be written by a concurrent run
+            if (file.last_write_time(itemError) < staleBefore && !itemError)
+                std::filesystem::remove(file.path(), itemError);
+            continue;
+        }
+        if (file.path().extension() != ".bfc")
+            continue;
+        uint64_t size = file.file_size(itemError);
+        std::filesystem::file_time_type used = file.last_write_time(itemError);
+        if (itemError)
+            continue;
+        items.push_back({used, size, file.path()});
+        total += size;
+    }
+    if (total <= sizeLimit)
+        return;
+
+    std::sort(items.begin(), items.end(), [](const Item &a, const Item &b) { return a.used < b.used; });
+    uint64_t evicted = 0;
+    for (const Item &item : items)
+    {
+        if (total <= sizeLimit)
+            break;
+        if (std::filesystem::remove(item.path, ec))
+        {
+            total -= item.size;
+            evicted++;
+        }
+    }
+
+    BASL_LOG_INFO("[Cache] Evicted " << evicted << " entries");
+    addStats(0, 0, evicted);
+}
+
+void FrontEndCache::addStats(uint64_t hits, uint64_t misses, uint64_t evictions)
+{
+    CacheStats current = readCounters();
+    std::ostringstream text;
+    text << "hits " << current.hits + hits << "\nmisses " << current.misses + misses << "\nevictions "
+         << current.evictions + evictions << "\n";
+    replaceFile((std::filesystem::path(directory) / "stats").string(), text.str());
+}
+
+CacheStats FrontEndCache::readCounters() const
+{
+    CacheStats stats;
+    std::ifstream file(std::filesystem::path(directory) / "stats");
+    std::string name;
+    uint64_t value;
+    while (file >> name >> value)
+    {
+        if (name == "hits")
+            stats.hits = value;
+        else if (name == "misses")
+            stats.misses = value;
+        else if (name == "evictions")
+            stats.evictions = value;
+    }
+    return stats;
+}
+
+CacheStats FrontEndCache::stats() const
+{
+    CacheStats stats = readCounters();
+    std::error_code ec;
+    for (const std::filesystem::directory_entry &file : std::filesystem::directory_iterator(directory, ec))
+    {
+        std::error_code itemError;
+        uint64_t size = file.file_size(itemError);
+        if (file.path().extension() != ".bfc" || itemError)
+            continue;
+        stats.entries++;
+        stats.bytes += size;
+    }
+    return stats;
+}
@@ -0,0 +1,111 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "astfile.hpp"
+#include "flatast.hpp"
+#include "mappedfile.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 128-bit content hash: four 64-bit multiply-rotate lanes over 32-byte
+// stripes, folded two different ways into the two halves. Fast, not
+// cryptographic; it identifies inputs, it does not authenticate them.
+struct ContentHash
+{
+    uint64_t high;
+    uint64_t low;
+
+    bool operator==(const ContentHash &other) const { return high == other.high && low == other.low; }
+    std::string hex() const;
+};
+
+ContentHash hashContent(std::string_view bytes, uint64_t seed = 0);
+
+// Cache key of a source file: the UTF-8 text readFile loaded, seeded with
+// the compiler version so a new build never reads an older build's entries.
+ContentHash frontEndCacheKey(std::string_view bytes, std::string_view version);
+
+// Cached front-end output for one source file: the binary AST and the
+// diagnostics text the parse printed. Read straight from a mapping of the
+// entry file. A hit never needs the token stream, so none is stored.
+class CacheEntry
+{
+public:
+    bool load(const std::string &path, const ContentHash &key);
+
+    const ASTImage &ast() const { return image; }
+    std::string_view astBytes() const { return astData; }
+    std::string_view diagnostics() const { return diagnosticText; }
+
+    struct Header
+    {
+        char magic[4]; // "BFEC"
+        uint32_t version;
+        uint64_t keyHigh;
+        uint64_t keyLow;
+        uint64_t astBytes;
+        uint64_t diagnosticBytes;
+    };
+
+private:
+    MappedFile mapping;
+    const Header *header = nullptr;
+    ASTImage image;
+    std::string_view astData;
+    std::string_view diagnosticText;
+};
+
+struct CacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+};
+
+// Content-addressed on-disk cache of front-end results, one file per key.
+// Entries are written to a temporary file and renamed into place, so
+// concurrent compiler runs never see half an entry. A hit refreshes the
+// entry's modification time, and storing evicts the least recently used
+// entries until the directory is back under `sizeLimit` bytes, and removes
+// temporary files a killed run left behind. Hit, miss and eviction counts
+// are kept in a `stats` file next to the entries, replaced the same way;
+// concurrent runs may lose an update there, but never tear the file.
+class FrontEndCache
+{
+public:
+    FrontEndCache(std::string directory, uint64_t sizeLimit);
+
+    bool lookup(const ContentHash &key, CacheEntry &entry);
+    bool store(const ContentHash &key, const FlatAST &ast, std::string_view diagnostics);
+
+    CacheStats stats() const;
+
+private:
+    std::string entryPath(const ContentHash &key) const;
+    void evict();
+    CacheStats readCounters() const;
+    void addStats(uint64_t hits, uint64_t misses, uint64_t evictions);
+
+    std::string directory;
+    uint64_t sizeLimit;
+};
@@ -0,0 +1,221 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+
+Incremental reparsing. Segments are cut after every ';' token, the same
+cut parallelparser.cpp relies on: the serial parser is in its initial state
+after each ';', so parsing the segments one by one gives the same result as
+parsing the whole text. The lexer likewise carries nothing but its position
+from one token to the next, so a segment boundary is also a point where a
+fresh lexer run agrees with the full one.
+
+An edit relexes the segments it overlaps as one region. The region is good
+if the lexer stops exactly at its end and its last token is a ';', in which
+case the next segment lexes as before. Otherwise (a ';' was deleted, or a
+string literal now runs on) the region grows by the next segment and is
+lexed again. The region is then cut into new segments, which are parsed,
+and the segments after it only have their start offsets moved.
+
+*/
+
+#include "incremental.hpp"
+#include "lexer.hpp"
+#include <algorithm>
+#include <iterator>
+
+// most segments are a single statement, far below the parser's default block
+static constexpr size_t segmentArenaBytes = 1024;
+
+IncrementalDocument::IncrementalDocument(std::string_view text) : lineIndex(text)
+{
+    TokenBuffer tokens(text);
+    size_t end = lexRange(text, 0, text.size(), tokens);
+    tokens.push(TK_EOF, static_cast<uint32_t>(end), 0);
+    segments = buildSegments(text, tokens, segmentStarts);
+}
+
+// Cuts a lexed region into segments, parses them and appends their starts
+// relative to the region to `starts`.
+IncrementalDocument::SegmentList IncrementalDocument::buildSegments(std::string_view region, const TokenBuffer &tokens,
+                                                                    std::vector<uint32_t> &starts) const
+{
+    SegmentList built;
+    size_t firstToken = 0;
+    uint32_t segmentStart = 0;
+
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        TokenKind kind = tokens.kind(i);
+        if (kind != TK_Semicolon && kind != TK_EOF)
+        {
+            continue;
+        }
+
+        uint32_t segmentEnd = kind == TK_EOF ? static_cast<uint32_t>(region.size()) : tokens.offset(i) + tokens.length(i);
+        std::unique_ptr<Segment> segment(
+            new Segment{std::string(region.substr(segmentStart, segmentEnd - segmentStart)), ParseResult()});
+
+        TokenBuffer segmentTokens(segment->text);
+        for (size_t j = firstToken; j <= i; j++)
+        {
+            segmentTokens.push(tokens.kind(j), tokens.offset(j) - segmentStart, tokens.length(j), tokens.symbol(j));
+        }
+        if (kind != TK_EOF)
+        {
+            segmentTokens.push(TK_EOF, segmentEnd - segmentStart, 0);
+        }
+
+        Parser parser(TokenStream(std::move(segmentTokens)), lineIndex, segmentArenaBytes);
+        segment->result = parser.parse();
+        built.push_back(std::move(segment));
+        starts.push_back(segmentStart);
+
+        firstToken = i + 1;
+        segmentStart = segmentEnd;
+    }
+
+    return built;
+}
+
+size_t IncrementalDocument::segmentAt(size_t offset) const
+{
+    auto it = std::upper_bound(segmentStarts.begin(), segmentStarts.end(), offset);
+    return static_cast<size_t>(it - segmentStarts.begin()) - 1;
+}
+
+void IncrementalDocument::applyEdit(size_t offset, size_t removed, std::string_view inserted)
+{
+    size_t total = size();
+    offset = std::min(offset, total);
+    removed = std::min(removed, total - offset);
+
+    size_t first = segmentAt(offset);
+    size_t last = segmentAt(offset + removed);
+    uint32_t regionStart = segmentStarts[first];
+
+    std::string region;
+    size_t regionSize;
+    TokenBuffer tokens;
+    while (true)
+    {
+        region.clear();
+        for (size_t i = first; i <= last; i++)
+        {
+            region += segments[i]->text;
+        }
+        region.replace(offset - regionStart, removed, inserted);
+        regionSize = region.size();
+
+        bool tail = last + 1 == segments.size();
+        if (!tail)
+        {
+            // lets a token that starts in the region be lexed to its true end
+            region += segments[last + 1]->text;
+        }
+
+        tokens = TokenBuffer(region);
+        size_t end = lexRange(region, 0, regionSize, tokens);
+        if (tail)
+        {
+            tokens.push(TK_EOF, static_cast<uint32_t>(end), 0);
+            break;
+        }
+
+        size_t count = tokens.size();
+        if (end == regionSize && count > 0 && tokens.kind(count - 1) == TK_Semicolon &&
+            tokens.offset(count - 1) + tokens.length(count - 1) == regionSize)
+        {
+            break;
+        }
+        last++;
+    }
+
+    std::vector<uint32_t> starts;
+    SegmentList replacement = buildSegments(std::string_view(region).substr(0, regionSize), tokens, starts);
+    for (uint32_t &start : starts)
+    {
+        start += regionStart;
+    }
+
+    uint32_t delta = static_cast<uint32_t>(inserted.size() - removed);
+    for (size_t i = last + 1; i < segmentStarts.size(); i++)
+    {
+        segmentStarts[i] += delta;
+    }
+
+    // overwrite in place where the counts overlap, so a typical keystroke
+    // does not move the segment list at all
+    size_t oldCount = last + 1 - first;
+    size_t common = std::min(oldCount, replacement.size());
+    std::move(replacement.begin(), replacement.begin() + common, segments.begin() + first);
+    std::copy(starts.begin(), starts.begin() + common, segmentStarts.begin() + first);
+    if (common < oldCount)
+    {
+        segments.erase(segments.begin() + first + common, segments.begin() + first + oldCount);
+        segmentStarts.erase(segmentStarts.begin() + first + common, segmentStarts.begin() + first + oldCount);
+    }
+    else
+    {
+        segments.insert(segments.begin() + first + common, std::make_move_iterator(replacement.begin() + common),
+                        std::make_move_iterator(replacement.end()));
+        segmentStarts.insert(segmentStarts.begin() + first + common, starts.begin() + common, starts.end());
+    }
+
+    lineIndex.applyEdit(static_cast<uint32_t>(offset), static_cast<uint32_t>(removed), inserted);
+}
+
+std::string IncrementalDocument::text() const
+{
+    std::string text;
+    text.reserve(size());
+    for (const std::unique_ptr<Segment> &segment : segments)
+    {
+        text += segment->text;
+    }
+    return text;
+}
+
+size_t IncrementalDocument::size() const
+{
+    return segmentStarts.back() + segments.back()->text.size();
+}
+
+std::vector<Stmt *> IncrementalDocument::statements() const
+{
+    std::vector<Stmt *> statements;
+    for (const std::unique_ptr<Segment> &segment : segments)
+    {
+        statements.insert(statements.end(), segment->result.statements.begin(), segment->result.statements.end());
+    }
+    return statements;
+}
+
+std::vector<Diagnostic> IncrementalDocument::diagnostics() const
+{
+    std::vector<Diagnostic> diagnostics;
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        for (Diagnostic diagnostic : segments[i]->result.diagnostics)
+        {
+            diagnostic.token.offset += segmentStarts[i];
+            diagnostics.push_back(diagnostic);
+        }
+    }
+    return diagnostics;
+}
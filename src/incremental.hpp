@@ -0,0 +1,71 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "lineindex.hpp"
+#include "parser.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A source buffer that stays lexed and parsed across edits, for editor
+// integration. The text is held as a run of segments, each ending with a
+// ';' token (the last one with EOF) and owning its own bytes, AST and
+// diagnostics. An edit relexes and reparses only the segments it touches;
+// every other segment, AST included, is kept as is and merely moves.
+//
+// Tokens in a segment's AST view into that segment's bytes and carry
+// offsets relative to its start. The Stmt pointers handed out stay valid
+// until an edit touches their segment.
+class IncrementalDocument
+{
+public:
+    explicit IncrementalDocument(std::string_view text);
+
+    // Replaces `removed` bytes at `offset` with `inserted`.
+    void applyEdit(size_t offset, size_t removed, std::string_view inserted);
+
+    std::string text() const;
+    size_t size() const;
+    const LineIndex &lines() const { return lineIndex; }
+
+    // Same statements and diagnostics as a full parse of text(); diagnostic
+    // offsets are absolute.
+    std::vector<Stmt *> statements() const;
+    std::vector<Diagnostic> diagnostics() const;
+
+    size_t segmentCount() const { return segments.size(); }
+
+private:
+    struct Segment
+    {
+        std::string text;
+        ParseResult result;
+    };
+
+    using SegmentList = std::vector<std::unique_ptr<Segment>>;
+
+    size_t segmentAt(size_t offset) const;
+    SegmentList buildSegments(std::string_view region, const TokenBuffer &tokens, std::vector<uint32_t> &starts) const;
+
+    SegmentList segments;
+    std::vector<uint32_t> segmentStarts; // document offset of each segment, kept apart for fast shifting
+    LineIndex lineIndex;
+};
@@ -0,0 +1,210 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "interner.hpp"
+#include <cstring>
+
+static inline uint64_t mixWord(uint64_t hash, uint64_t word)
+{
+    hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+    return hash ^ (hash >> 31);
+}
+
+uint64_t hashBytes(std::string_view bytes)
+{
+    const char *data = bytes.data();
+    size_t size = bytes.size();
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ size;
+
+    // long names run four independent lanes
+    if (size >= 32)
+    {
+        uint64_t lane0 = hash;
+        uint64_t lane1 = hash ^ 0x632BE59BD9B4E019ull;
+        uint64_t lane2 = hash ^ 0x8CB92BA72F3D8DD7ull;
+        uint64_t lane3 = hash ^ 0xD6E8FEB86659FD93ull;
+        for (; size >= 32; data += 32, size -= 32)
+        {
+            uint64_t words[4];
+            std::memcpy(words, data, 32);
+            lane0 = mixWord(lane0, words[0]);
+            lane1 = mixWord(lane1, words[1]);
+            lane2 = mixWord(lane2, words[2]);
+            lane3 = mixWord(lane3, words[3]);
+        }
+        hash = mixWord(mixWord(mixWord(lane0, lane1), lane2), lane3);
+    }
+
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        hash = mixWord(hash, word);
+    }
+    // the tail is read with fixed-size loads, overlapping when needed; the
+    // length is already part of the seed
+    if (size >= 4)
+    {
+        uint32_t low, high;
+        std::memcpy(&low, data, 4);
+        std::memcpy(&high, data + size - 4, 4);
+        hash = mixWord(hash, (uint64_t(high) << 32) | low);
+    }
+    else if (size > 0)
+    {
+        uint64_t word = uint8_t(data[0]) | (uint64_t(uint8_t(data[size / 2])) << 8) | (uint64_t(uint8_t(data[size - 1])) << 16);
+        hash = mixWord(hash, word);
+    }
+
+    hash ^= hash >> 29;
+    hash *= 0x94D049BB133111EBull;
+    return hash ^ (hash >> 32);
+}
+
+struct InternCacheEntry
+{
+    uint64_t owner = 0;
+    uint64_t hash = 0;
+    std::string_view text;
+    Symbol symbol = NoSymbol;
+};
+
+static thread_local std::array<InternCacheEntry, 1024> internCache;
+
+StringInterner::StringInterner()
+{
+    static std::atomic<uint64_t> nextId{1};
+    id = nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+Symbol StringInterner::intern(std::string_view text)
+{
+    uint64_t hash = hashBytes(text);
+    InternCacheEntry &entry = internCache[hash & (internCache.size() - 1)];
+    if (entry.owner == id && entry.hash == hash && entry.text == text)
+        return entry.symbol;
+
+    Symbol symbol = internSlow(text, hash);
+    entry = {id, hash, this->text(symbol), symbol};
+    return symbol;
+}
+
+// A symbol is (index in shard + 1) above the shard number, which keeps
+// NoSymbol free and lets text() find the shard without hashing.
+Symbol StringInterner::internSlow(std::string_view text, uint64_t hash)
+{
+    Shard &shard = shards[hash >> (64 - shardBits)];
+    uint32_t slotHash = static_cast<uint32_t>(hash);
+
+    std::lock_guard<std::mutex> guard(shard.lock);
+    if (shard.strings.size() * 2 >= shard.slots.size())
+        shard.grow();
+
+    size_t mask = shard.slots.size() - 1;
+    for (size_t i = slotHash & mask;; i = (i + 1) & mask)
+    {
+        Slot &slot = shard.slots[i];
+        if (slot.symbol == NoSymbol)
+        {
+            shard.strings.push_back(shard.store(text));
+            slot.hash = slotHash;
+            slot.symbol = static_cast<Symbol>((shard.strings.size() << shardBits) | (hash >> (64 - shardBits)));
+            return slot.symbol;
+        }
+        if (slot.hash == slotHash && shard.strings[(slot.symbol >> shardBits) - 1] == text)
+            return slot.symbol;
+    }
+}
+
+std::string_view StringInterner::text(Symbol symbol) const
+{
+    if (symbol == NoSymbol)
+        return {};
+    const Shard &shard = shards[symbol & ((1u << shardBits) - 1)];
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.strings[(symbol >> shardBits) - 1];
+}
+
+size_t StringInterner::size() const
+{
+    size_t count = 0;
+    for (const Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        count += shard.strings.size();
+    }
+    return count;
+}
+
+size_t StringInterner::storageBytes() const
+{
+    size_t bytes = 0;
+    for (const Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        bytes += shard.bytes;
+    }
+    return bytes;
+}
+
+std::string_view StringInterner::Shard::store(std::string_view text)
+{
+    // oversized strings get a block of their own
+    if (text.size() > blockBytes / 4)
+    {
+        blocks.emplace_back(new char[text.size()]);
+        std::memcpy(blocks.back().get(), text.data(), text.size());
+        bytes += text.size();
+        return {blocks.back().get(), text.size()};
+    }
+
+    if (blockUsed + text.size() > blockBytes)
+    {
+        blocks.emplace_back(new char[blockBytes]);
+        block = blocks.back().get();
+        blockUsed = 0;
+    }
+    char *target = block + blockUsed;
+    std::memcpy(target, text.data(), text.size());
+    blockUsed += text.size();
+    bytes += text.size();
+    return {target, text.size()};
+}
+
+void StringInterner::Shard::grow()
+{
+    std::vector<Slot> old = std::move(slots);
+    slots.assign(old.empty() ? 64 : old.size() * 2, Slot{});
+
+    size_t mask = slots.size() - 1;
+    for (const Slot &slot : old)
+    {
+        if (slot.symbol == NoSymbol)
+            continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].symbol != NoSymbol)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+StringInterner &symbolTable()
+{
+    static StringInterner interner;
+    return interner;
+}
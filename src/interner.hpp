@@ -0,0 +1,86 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Interned strings are identified by a 32-bit symbol. Two symbols from the
+// same interner are equal exactly when their strings are, so comparing
+// names is a single integer compare.
+using Symbol = uint32_t;
+constexpr Symbol NoSymbol = 0;
+
+uint64_t hashBytes(std::string_view bytes);
+
+// Thread-safe string interning table. Strings are spread over independently
+// locked shards by hash, so the lexer threads of lexParallel rarely contend,
+// and each thread keeps a small direct-mapped cache of recent symbols in
+// front of the shards, so repeated names take no lock at all. Every string
+// is copied once into the shard's block storage; the views returned by
+// text() stay valid for the interner's lifetime.
+class StringInterner
+{
+public:
+    StringInterner();
+
+    Symbol intern(std::string_view text);
+    std::string_view text(Symbol symbol) const;
+
+    // number of distinct strings and bytes of string storage
+    size_t size() const;
+    size_t storageBytes() const;
+
+private:
+    static constexpr unsigned shardBits = 6;
+    static constexpr size_t blockBytes = 64 * 1024;
+
+    struct Slot
+    {
+        uint32_t hash = 0;
+        Symbol symbol = NoSymbol;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex lock;
+        std::vector<Slot> slots;
+        std::vector<std::string_view> strings;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *block = nullptr; // block being filled
+        size_t blockUsed = blockBytes;
+        size_t bytes = 0;
+
+        std::string_view store(std::string_view text);
+        void grow();
+    };
+
+    Symbol internSlow(std::string_view text, uint64_t hash);
+
+    std::array<Shard, size_t(1) << shardBits> shards;
+    uint64_t id; // tags this interner's entries in the thread caches
+};
+
+// The process-wide interner the lexers write symbols into.
+StringInterner &symbolTable();
@@ -17,120 +17,62 @@ Copyright 2025-latest I. Mitterfellner
 */
 
 #include "lexer.hpp"
-#include <iostream>
+#include "lexertables.hpp"
+#include "scan.hpp"
 
 inline bool isIdentifierStart(char c)
 {
-    return std::isalpha(c) || c == '_';
+    return hasCharClass(c, CC_Alpha | CC_Underscore);
 }
 
-inline bool isIdentifierContinuation(char c)
+inline bool isDigit(char c)
 {
-    return std::isalnum(c) || c == '_';
+    return hasCharClass(c, CC_Digit);
 }
 
-std::vector<Token> lex(const std::string &inputString, const std::string filePath)
+size_t lexRange(std::string_view inputString, size_t begin, size_t stopAt, TokenBuffer &tokens)
 {
-    std::vector<Token> tokens;
-
-    std::unordered_map<std::string, TokenKind> keywords = {
-        {"int", TK_TypeInteger},
-        {"char", TK_TypeChar},
-        {"float", TK_TypeFloat},
-        {"string", TK_TypeString},
-        {"bool", TK_TypeBool}, // Add this
-        {"if", TK_KeywordIf},
-        {"else", TK_KeywordElse},
-        {"for", TK_KeywordFor},
-        {"function", TK_KeywordFunction},
-        {"return", TK_KeywordReturn},
-        {"print", TK_KeywordPrint}};
-
-    std::unordered_map<std::string, TokenKind> operators = {
-        {"+", TK_MathOperator},
-        {"-", TK_MathOperator},
-        {"*", TK_MathOperator},
-        {"/", TK_MathOperator},
-        {"%", TK_MathOperator},
-        {"=", TK_EqualsSign},
-        {"==", TK_ComparisonOperator},
-        {"!=", TK_ComparisonOperator},
-        {"<", TK_ComparisonOperator},
-        {">", TK_ComparisonOperator},
-        {"<=", TK_ComparisonOperator},
-        {">=", TK_ComparisonOperator},
-        {"&&", TK_LogicalOperator},
-        {"||", TK_LogicalOperator},
-        {"!", TK_LogicalOperator},
-        {";", TK_Semicolon},
-        {"(", TK_OpenParen},
-        {")", TK_CloseParen},
-        {"{", TK_OpenBrace},
-        {"}", TK_CloseBrace},
-        {",", TK_Comma}};
-
-    size_t pos = 0;
-    int line = 1;
-    int column = 1;
-
-    auto addToken = [&](TokenKind type, const std::string &value, int startColumn)
+    const ScanKernels &kernels = scanKernels();
+    StringInterner &interner = symbolTable();
+    const char *data = inputString.data();
+    const size_t end = inputString.length();
+
+    size_t pos = begin;
+
+    // Tokens only record offsets; line and column come from the source's
+    // LineIndex when they are needed.
+    auto addToken = [&](TokenKind type, size_t startPos)
     {
-        tokens.push_back({type, value, line, startColumn, column - 1});
+        Symbol symbol = isInternedKind(type) ? interner.intern(inputString.substr(startPos, pos - startPos)) : NoSymbol;
+        tokens.push(type, static_cast<uint32_t>(startPos), static_cast<uint32_t>(pos - startPos), symbol);
     };
 
-    while (pos < inputString.length())
+    while (pos < stopAt)
     {
         char currentChar = inputString[pos];
 
-        if (std::isspace(currentChar))
+        if (hasCharClass(currentChar, CC_Space))
         {
-            if (currentChar == '\n')
-            {
-                line++;
-                column = 1;
-            }
-            else
-            {
-                column++;
-            }
-            pos++;
+            pos = kernels.skipWhitespace(data, pos, end);
             continue;
         }
 
         if (isIdentifierStart(currentChar))
         {
             size_t startPos = pos;
-            int startColumn = column;
+            pos = kernels.skipIdentifier(data, pos + 1, end);
 
-            while (pos < inputString.length() && isIdentifierContinuation(inputString[pos]))
-            {
-                pos++;
-                column++;
-            }
-
-            std::string identifier = inputString.substr(startPos, pos - startPos);
-
-            auto it = keywords.find(identifier);
-            if (it != keywords.end())
-            {
-                addToken(it->second, identifier, startColumn);
-            }
-            else
-            {
-                addToken(TK_Identifier, identifier, startColumn);
-            }
+            addToken(lookupKeyword(inputString.substr(startPos, pos - startPos)), startPos);
             continue;
         }
 
-        if (currentChar == '-' && std::isdigit(inputString[pos + 1]))
+        if (currentChar == '-' && pos + 1 < inputString.length() && isDigit(inputString[pos + 1]))
         {
             pos++;
-            column++;
             size_t startPos = pos;
-            int startColumn = column;
             bool isFloat = false;
 
-            while (pos < inputString.length() && (std::isdigit(inputString[pos]) || inputString[pos] == '.'))
+            while (pos < inputString.length() && (isDigit(inputString[pos]) || inputString[pos] == '.'))
             {
                 if (inputString[pos] == '.')
                 {
@@ -141,11 +83,9 @@ std::vector<Token> lex(const std::string &inputString, const std::string filePat
                     isFloat = true;
                 }
                 pos++;
-                column++;
             }
 
-            std::string number = inputString.substr(startPos, pos - startPos);
-            addToken(isFloat ? TK_Float : TK_Integer, number, startColumn);
+            addToken(isFloat ? TK_Float : TK_Integer, startPos);
             continue;
         }
 
@@ -153,44 +93,35 @@ std::vector<Token> lex(const std::string &inputString, const std::string filePat
         if (currentChar == '\'')
         {
             size_t startPos = pos;
-            int startColumn = column;
             pos++;
-            column++;
 
             // Handle escape sequences
             if (pos < inputString.length() && inputString[pos] == '\\')
             {
                 pos++;
-                column++;
             }
 
             if (pos >= inputString.length() || inputString[pos] == '\'')
             {
                 // Invalid character literal (empty or unterminated)
-                pos++;
-                column++;
-                std::string charLit = inputString.substr(startPos, pos - startPos);
-                addToken(TK_String, charLit, startColumn);
+                pos = std::min(pos + 1, inputString.length());
+                addToken(TK_String, startPos);
                 continue;
             }
 
             // Get the actual character
             pos++;
-            column++;
 
             // Expect closing quote
             if (pos >= inputString.length() || inputString[pos] != '\'')
             {
                 // Unterminated character literal
-                std::string charLit = inputString.substr(startPos, pos - startPos);
-                addToken(TK_String, charLit, startColumn);
+                addToken(TK_String, startPos);
                 continue;
             }
 
             pos++;
-            column++;
-            std::string charLit = inputString.substr(startPos, pos - startPos);
-            addToken(TK_String, charLit, startColumn);
+            addToken(TK_String, startPos);
             continue;
         }
 
@@ -198,75 +129,58 @@ std::vector<Token> lex(const std::string &inputString, const std::string filePat
         if (currentChar == '"')
         {
             size_t startPos = pos;
-            int startColumn = column;
             pos++;
-            column++;
 
-            while (pos < inputString.length() && inputString[pos] != '"')
+            // jump between the bytes that need attention: the closing quote
+            // or an escape
+            while ((pos = kernels.findStringSpecial(data, pos, end)) < end && inputString[pos] != '"')
             {
-                if (inputString[pos] == '\\' && pos + 1 < inputString.length())
-                {
-                    pos += 2;
-                    column += 2;
-                }
-                else
-                {
-                    pos++;
-                    column++;
-                }
+                pos += pos + 1 < end ? 2 : 1;
             }
 
             if (pos >= inputString.length())
             {
                 // Unterminated string
-                std::string str = inputString.substr(startPos, pos - startPos);
-                addToken(TK_String, str, startColumn);
+                addToken(TK_String, startPos);
                 continue;
             }
 
             pos++;
-            column++;
-            std::string str = inputString.substr(startPos, pos - startPos);
-            addToken(TK_String, str, startColumn);
+            addToken(TK_String, startPos);
             continue;
         }
 
         // Handle operators
-        std::string op(1, currentChar);
-        if (pos + 1 < inputString.length())
+        const OperatorEntry &op = operatorTable[static_cast<unsigned char>(currentChar)];
+        if (op.pair != TK_Unknown && pos + 1 < inputString.length() && inputString[pos + 1] == op.pairSecond)
         {
-            std::string doubleOp = op + inputString[pos + 1];
-            auto it = operators.find(doubleOp);
-            if (it != operators.end())
-            {
-                addToken(it->second, doubleOp, column);
-                pos += 2;
-                column += 2;
-                continue;
-            }
+            pos += 2;
+            addToken(op.pair, pos - 2);
+            continue;
         }
 
-        auto it = operators.find(op);
-        if (it != operators.end())
+        if (op.single != TK_Unknown)
         {
-            addToken(it->second, op, column);
             pos++;
-            column++;
+            addToken(op.single, pos - 1);
             continue;
         }
 
-        // TODO: Calculate the proper end column
-        // reportError(filePath, line, column, column+5, "Unkown token");
-
+        // any other byte is not part of the language and is skipped; the
+        // dfa lexer does the same, so both produce identical streams
         pos++;
-        column++;
     }
 
-    // Add EOF token (only once)
-    if (tokens.empty() || tokens.back().type != TK_EOF)
-    {
-        tokens.push_back({TK_EOF, "", line, column, column});
-    }
+    return pos;
+}
+
+TokenBuffer lex(const SourceFile &source)
+{
+    std::string_view inputString = source.text();
+    TokenBuffer tokens(inputString);
+
+    size_t end = lexRange(inputString, 0, inputString.length(), tokens);
+    tokens.push(TK_EOF, static_cast<uint32_t>(end), 0);
 
     return tokens;
-}
\ No newline at end of file
+}
@@ -19,9 +19,25 @@ Copyright 2025-latest I. Mitterfellner
 #pragma once
 
 #include "tokens.hpp"
+#include "source.hpp"
 #include "errorhandler.hpp"
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
-std::vector<Token> lex(const std::string &inputString, const std::string filePath);
\ No newline at end of file
+TokenBuffer lex(const SourceFile &source);
+
+// Lexes every token whose scan starts in [begin, stopAt) and appends it to
+// `tokens`. The last token may run past stopAt. Returns the offset at which
+// the next scan would start; `begin` must be such an offset for the result
+// to match lex().
+size_t lexRange(std::string_view input, size_t begin, size_t stopAt, TokenBuffer &tokens);
+
+// Lexes `chunkCount` slices of the source on separate threads and stitches
+// the results together. The output is identical to lex(source).
+TokenBuffer lexParallel(const SourceFile &source, unsigned chunkCount);
+
+// Table-driven alternative to lex(), selected with `--lexer dfa`. It produces
+// an identical TokenBuffer and exists so the two engines can be benchmarked
+// against each other on the same input.
+TokenBuffer lexDFA(const SourceFile &source);
\ No newline at end of file
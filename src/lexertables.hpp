@@ -0,0 +1,128 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "tokens.hpp"
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+// Compile-time lookup tables shared by the hand-written and DFA lexers.
+
+struct KeywordEntry
+{
+    std::string_view text;
+    TokenKind kind = TK_Identifier;
+};
+
+inline constexpr KeywordEntry keywordList[] = {
+    {"int", TK_TypeInteger},
+    {"char", TK_TypeChar},
+    {"float", TK_TypeFloat},
+    {"string", TK_TypeString},
+    {"bool", TK_TypeBool},
+    {"if", TK_KeywordIf},
+    {"else", TK_KeywordElse},
+    {"for", TK_KeywordFor},
+    {"function", TK_KeywordFunction},
+    {"return", TK_KeywordReturn},
+    {"print", TK_KeywordPrint}};
+
+inline constexpr size_t keywordTableSize = 16;
+inline constexpr size_t keywordMinLength = 2;
+inline constexpr size_t keywordMaxLength = 8;
+
+// Coefficients were searched for so that every keyword lands in its own slot;
+// the static_assert below rejects any edit to keywordList that breaks that.
+constexpr size_t keywordHash(size_t length, char first, char last)
+{
+    return (length * 2 + static_cast<unsigned char>(first) * 5 + static_cast<unsigned char>(last) * 4) & (keywordTableSize - 1);
+}
+
+constexpr std::array<KeywordEntry, keywordTableSize> buildKeywordTable()
+{
+    std::array<KeywordEntry, keywordTableSize> table{};
+    for (const KeywordEntry &entry : keywordList)
+    {
+        table[keywordHash(entry.text.size(), entry.text.front(), entry.text.back())] = entry;
+    }
+    return table;
+}
+
+inline constexpr std::array<KeywordEntry, keywordTableSize> keywordTable = buildKeywordTable();
+
+constexpr bool keywordTableIsPerfect()
+{
+    size_t used = 0;
+    for (const KeywordEntry &entry : keywordTable)
+    {
+        used += entry.text.empty() ? 0 : 1;
+    }
+    return used == std::size(keywordList);
+}
+
+static_assert(keywordTableIsPerfect(), "keyword hash has a collision, pick new coefficients");
+
+inline TokenKind lookupKeyword(std::string_view word)
+{
+    if (word.size() < keywordMinLength || word.size() > keywordMaxLength)
+    {
+        return TK_Identifier;
+    }
+    const KeywordEntry &entry = keywordTable[keywordHash(word.size(), word.front(), word.back())];
+    return entry.text == word ? entry.kind : TK_Identifier;
+}
+
+// One entry per leading byte. `pair` is the kind produced when the next byte
+// is `pairSecond` ("==", "<=", "&&", ...), and is tried before `single`.
+struct OperatorEntry
+{
+    TokenKind single = TK_Unknown;
+    char pairSecond = 0;
+    TokenKind pair = TK_Unknown;
+};
+
+constexpr std::array<OperatorEntry, 256> buildOperatorTable()
+{
+    std::array<OperatorEntry, 256> table{};
+
+    table['+'].single = TK_MathOperator;
+    table['-'].single = TK_MathOperator;
+    table['*'].single = TK_MathOperator;
+    table['/'].single = TK_MathOperator;
+    table['%'].single = TK_MathOperator;
+    table[';'].single = TK_Semicolon;
+    table['('].single = TK_OpenParen;
+    table[')'].single = TK_CloseParen;
+    table['{'].single = TK_OpenBrace;
+    table['}'].single = TK_CloseBrace;
+    table[','].single = TK_Comma;
+
+    table['='] = {TK_EqualsSign, '=', TK_ComparisonOperator};
+    table['!'] = {TK_LogicalOperator, '=', TK_ComparisonOperator};
+    table['<'] = {TK_ComparisonOperator, '=', TK_ComparisonOperator};
+    table['>'] = {TK_ComparisonOperator, '=', TK_ComparisonOperator};
+    table['&'] = {TK_Unknown, '&', TK_LogicalOperator};
+    table['|'] = {TK_Unknown, '|', TK_LogicalOperator};
+
+    return table;
+}
+
+inline constexpr std::array<OperatorEntry, 256> operatorTable = buildOperatorTable();
@@ -0,0 +1,58 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "lineindex.hpp"
+#include "scan.hpp"
+#include <algorithm>
+
+LineIndex::LineIndex(std::string_view text) : lineStarts{0}
+{
+    scanKernels().collectLineStarts(text.data(), 0, text.size(), lineStarts);
+}
+
+void LineIndex::applyEdit(uint32_t offset, uint32_t removed, std::string_view inserted)
+{
+    // a line starts just past its '\n', so the removed newlines are the
+    // ones whose line start lies in (offset, offset + removed]
+    auto first = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    auto last = std::upper_bound(first, lineStarts.end(), offset + removed);
+
+    std::vector<uint32_t> added;
+    scanKernels().collectLineStarts(inserted.data(), 0, inserted.size(), added);
+    for (uint32_t &start : added)
+    {
+        start += offset;
+    }
+
+    uint32_t delta = static_cast<uint32_t>(inserted.size()) - removed;
+    for (auto it = last; it != lineStarts.end(); ++it)
+    {
+        *it += delta;
+    }
+
+    size_t firstIndex = first - lineStarts.begin();
+    lineStarts.erase(first, last);
+    lineStarts.insert(lineStarts.begin() + firstIndex, added.begin(), added.end());
+}
+
+SourcePosition LineIndex::position(uint32_t offset) const
+{
+    auto lineIt = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+    int line = static_cast<int>(lineIt - lineStarts.begin()) + 1;
+    return {line, static_cast<int>(offset - *lineIt) + 1};
+}
@@ -0,0 +1,52 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 1-based line and byte column of a source offset.
+struct SourcePosition
+{
+    int line;
+    int column;
+};
+
+// Start offset of every line of a source buffer, collected in one vector
+// scan. The lexers only deal in byte offsets; a position is resolved here
+// when a diagnostic or a dump actually asks for one.
+class LineIndex
+{
+public:
+    LineIndex() : lineStarts{0} {}
+    explicit LineIndex(std::string_view text);
+
+    SourcePosition position(uint32_t offset) const;
+
+    // Updates the index for `removed` bytes at `offset` being replaced by
+    // `inserted`, without rescanning the rest of the text.
+    void applyEdit(uint32_t offset, uint32_t removed, std::string_view inserted);
+
+    size_t lineCount() const { return lineStarts.size(); }
+    uint32_t lineStart(size_t line) const { return lineStarts[line - 1]; }
+
+private:
+    std::vector<uint32_t> lineStarts;
+};
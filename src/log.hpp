@@ -0,0 +1,71 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// Process logging. Messages go to std::clog and are only formatted when
+// their level is enabled, so a disabled call costs one compare. By default
+// only errors and warnings are shown; -log adds LL_Info (phase banners)
+// and -alog everything down to LL_Trace (per-token parser tracing).
+enum LogLevel : uint8_t
+{
+    LL_Error,
+    LL_Warning,
+    LL_Info,
+    LL_Debug,
+    LL_Trace,
+};
+
+inline LogLevel logThreshold = LL_Warning;
+
+inline void setLogLevel(LogLevel level) { logThreshold = level; }
+inline bool logEnabled(LogLevel level) { return level <= logThreshold; }
+
+// Trace calls sit in the lexer and parser hot loops. They are compiled out
+// entirely in release (NDEBUG) builds unless BASL_TRACE_ENABLED is set.
+#ifndef BASL_TRACE_ENABLED
+#ifdef NDEBUG
+#define BASL_TRACE_ENABLED 0
+#else
+#define BASL_TRACE_ENABLED 1
+#endif
+#endif
+
+#define BASL_LOG(level, message)                \
+    do                                          \
+    {                                           \
+        if (logEnabled(level))                  \
+            std::clog << message << '\n';       \
+    } while (0)
+
+#define BASL_LOG_ERROR(message) BASL_LOG(LL_Error, message)
+#define BASL_LOG_WARNING(message) BASL_LOG(LL_Warning, message)
+#define BASL_LOG_INFO(message) BASL_LOG(LL_Info, message)
+#define BASL_LOG_DEBUG(message) BASL_LOG(LL_Debug, message)
+
+#if BASL_TRACE_ENABLED
+#define BASL_LOG_TRACE(message) BASL_LOG(LL_Trace, message)
+#else
+#define BASL_LOG_TRACE(message) \
+    do                          \
+    {                           \
+    } while (0)
+#endif
@@ -17,12 +17,22 @@ Copyright 2025-latest I. Mitterfellner
 */
 
 #include "file.hpp"
+#include "source.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
+#include "flatast.hpp"
+#include "astfile.hpp"
+#include "frontendcache.hpp"
 #include "runargs.hpp"
+#include "log.hpp"
 #include "spinner.hpp"
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <memory>
+#include <thread>
 #include <csignal>
 #include <cstdlib>
 
@@ -37,6 +47,15 @@ void exitSignalHandler(int signalIndex)
     exit(signalIndex);
 }
 
+static void printCacheStats(const FrontEndCache &cache, bool requested)
+{
+    if (!requested)
+        return;
+    CacheStats stats = cache.stats();
+    std::cerr << "front-end cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+              << " evictions, " << stats.entries << " entries, " << stats.bytes << " bytes" << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
     // Abnormal termination of the program, such as a call to abort.
@@ -63,38 +82,131 @@ int main(int argc, char *argv[])
 
     // AAHHH 
 
+    setLogLevel(advancedProccessLogs ? LL_Trace : generalProccessLogs ? LL_Info : LL_Warning);
+
     if (inputPath.length() == 0)
     {
         std::cout << "File input path Invalid\n";
         exit(1);
     }
 
+    if (runArgs.loadAST)
+    {
+        BASL_LOG_INFO("Loading AST file");
+        ASTImage image;
+        if (!image.load(inputPath))
+        {
+            std::cerr << "Invalid AST file: " << inputPath << std::endl;
+            return 1;
+        }
+        printFlatAST(image, std::cout);
+        std::cout << std::endl;
+        return 0;
+    }
+
     try
     {
-        std::cout << "Starting File Read" << std::endl;
-        std::string content = readFile(inputPath).fileContent;
-        std::cout << "File Read" << std::endl;
-
-        std::cout << "Starting Lex" << std::endl;
-        auto tokens = lex(content, inputPath);
-        std::cout << "Ended Lex" << std::endl;
-
-        std::cout << "Initing parser" << std::endl;
-        Parser parser(tokens);
-        std::cout << "Inited parser" << std::endl;
-        try
+        BASL_LOG_INFO("Starting File Read");
+        // the source buffer is kept alive until after the AST is printed,
+        // since every token and AST node views into it
+        fileStruct file = readFile(inputPath);
+        if (!file.fileReadSuccess)
+        {
+            std::cerr << "File read failed: " << inputPath << std::endl;
+            return 1;
+        }
+        SourceFile source{inputPath, std::move(file.fileContent), std::move(file.fileMapping)};
+        BASL_LOG_INFO("File Read");
+
+        // an unchanged input is served from the cache without being lexed
+        // or parsed; the output is the same as the flat dump. Compare mode
+        // is there to time the lexers, so it never uses the cache.
+        std::unique_ptr<FrontEndCache> cache;
+        ContentHash cacheKey{};
+        if (runArgs.useCache && runArgs.lexerMode != "compare")
         {
-            std::cout << "Starting parser..." << std::endl;
-            auto statements = parser.parse();
-            std::cout << "Parsing completed successfully! Found "
-                      << statements.size() << " statements" << std::endl;
+            cacheKey = frontEndCacheKey(source.text(), version);
+            cache = std::make_unique<FrontEndCache>(runArgs.cacheDir, uint64_t(std::max(runArgs.cacheSizeMB, 0)) << 20);
+            CacheEntry entry;
+            if (cache->lookup(cacheKey, entry))
+            {
+                std::cerr << entry.diagnostics();
+                if (!runArgs.emitASTPath.empty() && !writeASTFile(entry.astBytes(), runArgs.emitASTPath))
+                {
+                    std::cerr << "AST write failed: " << runArgs.emitASTPath << std::endl;
+                    return 1;
+                }
+                printFlatAST(entry.ast(), std::cout);
+                std::cout << std::endl;
+                printCacheStats(*cache, runArgs.cacheStats);
+                return 0;
+            }
+        }
 
-            std::cout << parser.printAST(statements) << std::endl;
+        BASL_LOG_INFO("Starting Lex");
+        unsigned jobs = runArgs.jobs > 0 ? static_cast<unsigned>(runArgs.jobs) : std::thread::hardware_concurrency();
+        TokenBuffer tokens;
+        if (runArgs.lexerMode == "compare")
+        {
+            auto handStart = std::chrono::steady_clock::now();
+            tokens = lex(source);
+            auto dfaStart = std::chrono::steady_clock::now();
+            TokenBuffer dfaTokens = lexDFA(source);
+            auto dfaEnd = std::chrono::steady_clock::now();
+
+            std::cout << "hand lexer: " << std::chrono::duration<double, std::milli>(dfaStart - handStart).count() << " ms, "
+                      << "dfa lexer: " << std::chrono::duration<double, std::milli>(dfaEnd - dfaStart).count() << " ms, "
+                      << tokens.size() << " tokens" << std::endl;
+            if (tokens != dfaTokens)
+            {
+                std::cerr << "Lexer mismatch: hand and dfa token streams differ" << std::endl;
+                return 1;
+            }
+            std::cout << "Token streams identical" << std::endl;
         }
-        catch (const std::runtime_error &e)
+        else if (runArgs.lexerMode != "stream")
         {
-            std::cerr << "Parsing failed: " << e.what() << std::endl;
-            return 1;
+            tokens = runArgs.lexerMode == "dfa" ? lexDFA(source) : lexParallel(source, jobs);
+        }
+        BASL_LOG_INFO("Ended Lex");
+
+        BASL_LOG_INFO("Initing parser");
+        // in stream mode the parser drives the lexer itself, one slice at a time
+        Parser parser(runArgs.lexerMode == "stream" ? TokenStream(source) : TokenStream(std::move(tokens)), source.lines);
+        BASL_LOG_INFO("Inited parser");
+        BASL_LOG_INFO("Starting parser...");
+        ParseResult result = parser.parse(jobs);
+        std::ostringstream diagnostics;
+        parser.printDiagnostics(result, cache ? diagnostics : std::cerr);
+        std::cerr << diagnostics.str();
+        BASL_LOG_INFO("Parsing completed! Found " << result.statements.size() << " statements, "
+                                                  << result.diagnostics.size() << " errors");
+
+        if (runArgs.astFormat == "flat" || !runArgs.emitASTPath.empty() || cache)
+        {
+            FlatAST flat = flattenAST(result, source.text());
+            if (cache)
+            {
+                cache->store(cacheKey, flat, diagnostics.str());
+            }
+            if (!runArgs.emitASTPath.empty() && !writeASTFile(flat, runArgs.emitASTPath))
+            {
+                std::cerr << "AST write failed: " << runArgs.emitASTPath << std::endl;
+                return 1;
+            }
+            if (runArgs.astFormat == "flat")
+            {
+                printFlatAST(flat, std::cout);
+            }
+        }
+        if (runArgs.astFormat != "flat")
+        {
+            parser.printAST(result, std::cout);
+        }
+        std::cout << std::endl;
+        if (cache)
+        {
+            printCacheStats(*cache, runArgs.cacheStats);
         }
     }
     catch (...)
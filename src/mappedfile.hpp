@@ -0,0 +1,58 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file. The mapping is released when
+// the object is destroyed, so any view handed out must not outlive it.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Maps `path` and hints the kernel that it will be read front to back.
+    // Returns false (leaving the object unmapped) for empty files and for
+    // anything the OS refuses to map, such as pipes and character devices.
+    bool map(const std::string &path);
+
+    bool isMapped() const { return data != nullptr; }
+    std::string_view view() const { return {data + viewStart, size - viewStart}; }
+
+    // Drops the first `bytes` of view(), e.g. a byte order mark, without
+    // copying the rest. The whole file stays mapped.
+    void skipPrefix(size_t bytes) { viewStart += bytes; }
+
+private:
+    void unmap();
+
+    const char *data = nullptr;
+    size_t size = 0;
+    size_t viewStart = 0;
+#ifdef _WIN32
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,85 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Buffered writer for dumps. Text is collected in a fixed-size buffer and
+// handed to the stream in large writes, so memory use does not grow with
+// the size of the output.
+class OutputSink
+{
+public:
+    explicit OutputSink(std::ostream &out, size_t bufferBytes = 64 * 1024) : out(out)
+    {
+        buffer.reserve(bufferBytes);
+    }
+    ~OutputSink() { flush(); }
+
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+
+    OutputSink &operator<<(std::string_view text)
+    {
+        if (buffer.size() + text.size() > buffer.capacity())
+        {
+            flush();
+            if (text.size() > buffer.capacity())
+            {
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return *this;
+            }
+        }
+        buffer.append(text);
+        return *this;
+    }
+
+    OutputSink &operator<<(char c)
+    {
+        if (buffer.size() == buffer.capacity())
+            flush();
+        buffer.push_back(c);
+        return *this;
+    }
+
+    // two spaces per level, copied from a constant run of spaces
+    void indent(int level)
+    {
+        static const std::string spaces(256, ' ');
+        for (size_t remaining = static_cast<size_t>(level) * 2; remaining > 0;)
+        {
+            size_t chunk = std::min(remaining, spaces.size());
+            *this << std::string_view(spaces.data(), chunk);
+            remaining -= chunk;
+        }
+    }
+
+    void flush()
+    {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+private:
+    std::ostream &out;
+    std::string buffer;
+};
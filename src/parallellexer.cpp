@@ -0,0 +1,121 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+
+Parallel lexing. The source is cut into equal byte ranges and each range is
+lexed on its own thread as if a token started exactly at its first byte.
+That guess is wrong whenever the previous range's last token (usually a
+string or char literal) runs across the cut.
+
+The lexer carries no state between tokens besides its position, so two runs
+that ever emit the same token (same offset, length and kind) agree on every
+token after it. Stitching therefore walks the ranges in order: a range whose
+start is where serial lexing would be anyway is taken as-is, otherwise it is
+relexed one token at a time from the true position until a token matches
+the speculative output, and the rest of the speculative tokens are reused.
+
+*/
+
+#include "lexer.hpp"
+#include <thread>
+
+struct LexChunk
+{
+    size_t begin = 0;
+    size_t stopAt = 0;
+    size_t end = 0; // where the speculative run stopped, >= stopAt
+    TokenBuffer tokens;
+};
+
+static void lexChunk(std::string_view input, LexChunk &chunk)
+{
+    chunk.tokens = TokenBuffer(input);
+    chunk.end = lexRange(input, chunk.begin, chunk.stopAt, chunk.tokens);
+}
+
+TokenBuffer lexParallel(const SourceFile &source, unsigned chunkCount)
+{
+    std::string_view input = source.text();
+    if (chunkCount <= 1 || input.size() < chunkCount)
+    {
+        return lex(source);
+    }
+
+    std::vector<LexChunk> chunks(chunkCount);
+    for (unsigned i = 0; i < chunkCount; i++)
+    {
+        chunks[i].begin = input.size() * i / chunkCount;
+        chunks[i].stopAt = input.size() * (i + 1) / chunkCount;
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < chunkCount; i++)
+    {
+        workers.emplace_back(lexChunk, input, std::ref(chunks[i]));
+    }
+    lexChunk(input, chunks[0]);
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    TokenBuffer tokens(input);
+    size_t pos = 0;
+
+    for (LexChunk &chunk : chunks)
+    {
+        if (pos == chunk.begin)
+        {
+            tokens.append(chunk.tokens, 0);
+            pos = chunk.end;
+            continue;
+        }
+
+        // the previous chunk's last token ran past chunk.begin
+        size_t candidate = 0;
+        while (pos < chunk.stopAt)
+        {
+            size_t before = tokens.size();
+            pos = lexRange(input, pos, pos + 1, tokens);
+            if (tokens.size() == before)
+            {
+                continue;
+            }
+
+            size_t last = tokens.size() - 1;
+            while (candidate < chunk.tokens.size() && chunk.tokens.offset(candidate) < tokens.offset(last))
+            {
+                candidate++;
+            }
+
+            if (candidate < chunk.tokens.size() &&
+                chunk.tokens.offset(candidate) == tokens.offset(last) &&
+                chunk.tokens.length(candidate) == tokens.length(last) &&
+                chunk.tokens.kind(candidate) == tokens.kind(last))
+            {
+                tokens.append(chunk.tokens, candidate + 1);
+                pos = chunk.end;
+                break;
+            }
+        }
+    }
+
+    tokens.push(TK_EOF, static_cast<uint32_t>(pos), 0);
+    return tokens;
+}
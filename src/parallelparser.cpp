@@ -0,0 +1,145 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+/*
+
+Parallel parsing. Every statement of the grammar ends at its ';', and no
+rule reads past a ';' it has consumed: a finished statement stops right
+after it, and synchronize() stops there at the latest. Error recovery never
+crosses one either. So the serial parser is in its initial state after
+every ';' token, and the token stream can be cut after any ';' and the
+pieces parsed independently.
+
+The pre-scan cuts the tokens into a few chunks per thread at the first ';'
+after evenly spaced token indices. Threads take chunks off a shared counter
+until none are left, each parsing into its own ParseResult. The results are
+then joined in token order: statements and diagnostics are concatenated and
+the chunk arenas are adopted by the final result.
+
+Braces do not need depth tracking yet; the grammar has no blocks, so a '{'
+is a syntax error and the serial parser also resynchronizes at the next
+';' inside it.
+
+*/
+
+#include "parser.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// below this many tokens per chunk the thread start-up costs more than it saves
+static constexpr size_t minChunkTokens = 16 * 1024;
+
+struct ParseChunk
+{
+    size_t begin = 0;
+    size_t end = 0;
+    ParseResult result;
+};
+
+static std::vector<ParseChunk> splitAtStatements(const TokenBuffer &tokens, size_t chunkCount)
+{
+    std::vector<ParseChunk> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i < chunkCount; i++)
+    {
+        size_t cut = std::max(begin, tokens.size() * i / chunkCount);
+        while (cut < tokens.size() && tokens.kind(cut) != TK_Semicolon)
+        {
+            cut++;
+        }
+        if (cut >= tokens.size() - 1)
+        {
+            break;
+        }
+
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = cut + 1;
+        begin = cut + 1;
+    }
+
+    // the last chunk keeps the EOF token
+    chunks.emplace_back();
+    chunks.back().begin = begin;
+    chunks.back().end = tokens.size();
+    return chunks;
+}
+
+static void parseChunk(const TokenBuffer &tokens, const LineIndex &lines, ParseChunk &chunk)
+{
+    TokenBuffer slice(tokens.sourceText());
+    slice.append(tokens, chunk.begin, chunk.end);
+    if (chunk.end < tokens.size())
+    {
+        slice.push(TK_EOF, tokens.offset(chunk.end), 0);
+    }
+
+    Parser parser(TokenStream(std::move(slice)), lines);
+    chunk.result = parser.parse();
+}
+
+ParseResult Parser::parse(unsigned jobs)
+{
+    const TokenBuffer *all = tokens.buffered();
+    size_t chunkCount = all ? std::min<size_t>(size_t(jobs) * 4, all->size() / minChunkTokens) : 0;
+    if (jobs <= 1 || chunkCount <= 1 || current != 0)
+    {
+        return parse();
+    }
+
+    std::vector<ParseChunk> chunks = splitAtStatements(*all, chunkCount);
+    BASL_LOG_DEBUG("[Parser] Parsing " << chunks.size() << " chunks on " << jobs << " threads");
+
+    std::atomic<size_t> nextChunk{0};
+    auto work = [&]()
+    {
+        for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++)
+        {
+            parseChunk(*all, lines, chunks[i]);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min<size_t>(jobs, chunks.size()); i++)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    ParseResult result;
+    for (ParseChunk &chunk : chunks)
+    {
+        result.arena.adopt(std::move(chunk.result.arena));
+        result.statements.insert(result.statements.end(), chunk.result.statements.begin(),
+                                 chunk.result.statements.end());
+        result.diagnostics.insert(result.diagnostics.end(), chunk.result.diagnostics.begin(),
+                                  chunk.result.diagnostics.end());
+    }
+
+    current = all->size() - 1;
+    tokens.seek(current);
+    BASL_LOG_DEBUG("[Parser] Finished parsing. Found " << result.statements.size() << " statements, "
+                                                       << result.diagnostics.size() << " errors");
+    return result;
+}
@@ -17,86 +17,127 @@ limitations under the License.
 */
 
 #include "parser.hpp"
+#include "log.hpp"
 #include <iostream>
+#include <sstream>
+#include <array>
 
-Parser::Parser(std::vector<Token> tokens) : tokens(std::move(tokens)) {}
+// Binary operator precedence, higher binds tighter.
+enum Precedence : uint8_t
+{
+    PR_None, // not a binary operator
+    PR_Or,
+    PR_And,
+    PR_Equality,
+    PR_Comparison,
+    PR_Term,
+    PR_Factor,
+};
+
+// Operator tokens are told apart by their bytes: the first byte, with bit 7
+// set for the two-byte operators. Source bytes >= 0x80 never form operators.
+constexpr uint8_t operatorKey(char first, size_t length)
+{
+    return static_cast<uint8_t>(static_cast<uint8_t>(first) | (length == 2 ? 0x80 : 0));
+}
 
-std::vector<std::unique_ptr<Stmt>> Parser::parse()
+inline uint8_t operatorKey(std::string_view op)
 {
-    std::cout << "[Parser] Starting parse with " << tokens.size() << " tokens\n";
-    std::vector<std::unique_ptr<Stmt>> statements;
-    int loopCount = 0;
-    const int MAX_LOOPS = 100;
+    return operatorKey(op[0], op.size());
+}
 
-    while (!isAtEnd() && loopCount < MAX_LOOPS)
-    {
-        loopCount++;
-        std::cout << "[Parser] Token #" << current << ": '"
-                  << peek().value << "' (type: "
-                  << static_cast<int>(peek().type) << ")\n";
+constexpr std::array<uint8_t, 256> buildPrecedenceTable()
+{
+    std::array<uint8_t, 256> table{};
+    table[operatorKey('|', 2)] = PR_Or;
+    table[operatorKey('&', 2)] = PR_And;
+    table[operatorKey('=', 2)] = PR_Equality;
+    table[operatorKey('!', 2)] = PR_Equality;
+    table[operatorKey('<', 1)] = PR_Comparison;
+    table[operatorKey('>', 1)] = PR_Comparison;
+    table[operatorKey('<', 2)] = PR_Comparison;
+    table[operatorKey('>', 2)] = PR_Comparison;
+    table[operatorKey('+', 1)] = PR_Term;
+    table[operatorKey('-', 1)] = PR_Term;
+    table[operatorKey('*', 1)] = PR_Factor;
+    table[operatorKey('/', 1)] = PR_Factor;
+    table[operatorKey('%', 1)] = PR_Factor;
+    return table;
+}
 
-        try
-        {
-            auto stmt = declaration();
-            if (stmt)
-            {
-                statements.push_back(std::move(stmt));
-            }
-        }
-        catch (const std::runtime_error &e)
+static constexpr std::array<uint8_t, 256> precedenceTable = buildPrecedenceTable();
+
+Parser::Parser(TokenStream tokens, const LineIndex &lines, size_t arenaBlockBytes)
+    : tokens(std::move(tokens)), lines(lines), arenaBlockBytes(arenaBlockBytes)
+{
+}
+
+ParseResult Parser::parse()
+{
+    BASL_LOG_DEBUG("[Parser] Starting parse");
+    ParseResult result{Arena(arenaBlockBytes), {}, {}};
+    arena = &result.arena;
+    std::vector<Stmt *> &statements = result.statements;
+
+    while (!isAtEnd())
+    {
+        BASL_LOG_TRACE("[Parser] Token #" << current << ": '" << tokens.text(current)
+                                          << "' (type: " << static_cast<int>(tokens.kind(current)) << ")");
+
+        // every round has to consume at least one token, otherwise the
+        // offending token is reported and skipped
+        size_t start = current;
+        Stmt *stmt = declaration();
+        if (stmt)
         {
-            std::cerr << "[Parser] Error: " << e.what() << std::endl;
-            synchronize();
+            statements.push_back(stmt);
         }
 
-        if (current >= tokens.size())
+        if (current == start && !isAtEnd())
         {
-            std::cout << "[Parser] Reached end of token stream\n";
-            break;
+            error(peek(), "Unexpected token");
+            advance();
         }
     }
 
-    if (loopCount >= MAX_LOOPS)
-    {
-        std::cerr << "[Parser] WARNING: Loop limit reached. Possible infinite loop\n";
-    }
-
-    std::cout << "[Parser] Finished parsing. Found "
-              << statements.size() << " statements\n";
-    return statements;
+    BASL_LOG_DEBUG("[Parser] Finished parsing. Found " << statements.size() << " statements, "
+                                                       << diagnostics.size() << " errors");
+    result.diagnostics = std::move(diagnostics);
+    diagnostics.clear();
+    arena = nullptr;
+    return result;
 }
 
 bool Parser::isAtEnd() const
 {
-    return current >= tokens.size() || tokens[current].type == TK_EOF;
+    return tokens.kind(current) == TK_EOF;
 }
 
-const Token &Parser::peek() const
+Token Parser::peek() const
 {
     return tokens[current];
 }
 
-const Token &Parser::previous() const
+Token Parser::previous() const
 {
     return tokens[current - 1];
 }
 
-const Token &Parser::advance()
+void Parser::advance()
 {
     if (!isAtEnd())
     {
-        std::cout << "[Parser] Advancing from token #" << current << ": '"
-                  << tokens[current].value << "'\n";
+        BASL_LOG_TRACE("[Parser] Advancing from token #" << current << ": '" << tokens.text(current) << "'");
         current++;
+        tokens.seek(current);
     }
-    return previous();
 }
 
 bool Parser::check(TokenKind type) const
 {
     if (isAtEnd())
         return false;
-    return peek().type == type;
+    return tokens.kind(current) == type;
 }
 
 bool Parser::match(TokenKind type)
@@ -109,30 +150,18 @@ bool Parser::match(TokenKind type)
     return false;
 }
 
-bool Parser::match(const std::vector<TokenKind> &types)
-{
-    for (TokenKind type : types)
-    {
-        if (check(type))
-        {
-            advance();
-            return true;
-        }
-    }
-    return false;
-}
-
-Token Parser::consume(TokenKind type, const std::string &message)
+bool Parser::consume(TokenKind type, std::string_view message)
 {
-    if (check(type))
-        return advance();
+    if (match(type))
+        return true;
     error(peek(), message);
-    throw std::runtime_error(message);
+    return false;
 }
 
-void Parser::error(const Token &token, const std::string &message)
+void Parser::error(const Token &token, std::string_view message)
 {
-    std::cerr << "[Line " << token.line << "] Error at '" << token.value << "': " << message << std::endl;
+    BASL_LOG_DEBUG("[Parser] Error: " << message);
+    diagnostics.push_back({token, message});
 }
 
 void Parser::synchronize()
@@ -141,10 +170,10 @@ void Parser::synchronize()
 
     while (!isAtEnd())
     {
-        if (previous().type == TK_Semicolon)
+        if (tokens.kind(current - 1) == TK_Semicolon)
             return;
 
-        switch (peek().type)
+        switch (tokens.kind(current))
         {
         case TK_TypeInteger:
         case TK_TypeFloat:
@@ -158,39 +187,45 @@ void Parser::synchronize()
     }
 }
 
-std::unique_ptr<Stmt> Parser::declaration()
+Stmt *Parser::declaration()
 {
-    try
+    if (match<TK_TypeInteger, TK_TypeFloat, TK_TypeChar, TK_TypeString>())
     {
-        if (match({TK_TypeInteger, TK_TypeFloat, TK_TypeChar, TK_TypeString}))
-        {
-            return varDeclaration();
-        }
-        return statement();
-    }
-    catch (const std::runtime_error &)
-    {
-        synchronize();
-        return nullptr;
+        return varDeclaration();
     }
+    return statement();
 }
 
-std::unique_ptr<Stmt> Parser::varDeclaration()
+Stmt *Parser::varDeclaration()
 {
     Token type = previous();
-    Token name = consume(TK_Identifier, "Expected variable name after type");
+    if (!consume(TK_Identifier, "Expected variable name after type"))
+    {
+        synchronize();
+        return nullptr;
+    }
+    Token name = previous();
 
-    std::unique_ptr<Expr> initializer = nullptr;
+    Expr *initializer = nullptr;
     if (match(TK_EqualsSign))
     {
         initializer = expression();
+        if (!initializer)
+        {
+            synchronize();
+            return nullptr;
+        }
     }
 
-    consume(TK_Semicolon, "Expected ';' after variable declaration");
-    return std::make_unique<VarDeclaration>(type, name, std::move(initializer));
+    if (!consume(TK_Semicolon, "Expected ';' after variable declaration"))
+    {
+        synchronize();
+        return nullptr;
+    }
+    return arena->make<VarDeclaration>(type, name, initializer);
 }
 
-std::unique_ptr<Stmt> Parser::statement()
+Stmt *Parser::statement()
 {
     if (isAtEnd())
     {
@@ -202,221 +237,195 @@ std::unique_ptr<Stmt> Parser::statement()
         return nullptr;
     }
 
-    try
-    {
-        auto expr = expression();
-        if (match(TK_Semicolon))
-        {
-            return std::make_unique<ExprStmt>(std::move(expr));
-        }
-        else
-        {
-            error(peek(), "Expected ';' after expression");
-            synchronize();
-            return nullptr;
-        }
-    }
-    catch (const std::runtime_error &e)
+    Expr *expr = expression();
+    if (!expr)
     {
         synchronize();
         return nullptr;
     }
-}
-
-std::unique_ptr<Expr> Parser::expression()
-{
-    return equality();
-}
-
-std::unique_ptr<Expr> Parser::equality()
-{
-    auto expr = comparison();
 
-    while (match({TK_ComparisonOperator}))
+    if (!consume(TK_Semicolon, "Expected ';' after expression"))
     {
-        Token op = previous();
-        auto right = comparison();
-        expr = std::make_unique<BinaryExpr>(op, std::move(expr), std::move(right));
+        synchronize();
+        return nullptr;
     }
-
-    return expr;
+    return arena->make<ExprStmt>(expr);
 }
 
-std::unique_ptr<Expr> Parser::comparison()
+Expr *Parser::expression(uint8_t minPrecedence)
 {
-    auto expr = term();
+    Expr *expr = unary();
+    if (!expr)
+        return nullptr;
 
-    while (match({TK_ComparisonOperator}))
+    // precedence climbing: the right operand only takes operators that bind
+    // tighter than this one, which makes every level left-associative
+    uint8_t precedence;
+    while ((precedence = binaryPrecedence()) >= minPrecedence)
     {
+        advance();
         Token op = previous();
-        auto right = term();
-        expr = std::make_unique<BinaryExpr>(op, std::move(expr), std::move(right));
+        Expr *right = expression(precedence + 1);
+        if (!right)
+            return nullptr;
+        expr = arena->make<BinaryExpr>(op, expr, right);
     }
 
     return expr;
 }
 
-std::unique_ptr<Expr> Parser::term()
+uint8_t Parser::binaryPrecedence() const
 {
-    auto expr = factor();
-
-    while (match(TK_MathOperator))
-    {
-        std::string op_val = previous().value;
-        if (op_val == "+" || op_val == "-")
-        {
-            Token op = previous();
-            auto right = factor();
-            expr = std::make_unique<BinaryExpr>(op, std::move(expr), std::move(right));
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    return expr;
+    if (!check<TK_MathOperator, TK_ComparisonOperator, TK_LogicalOperator>())
+        return PR_None;
+    return precedenceTable[operatorKey(tokens.text(current))];
 }
 
-std::unique_ptr<Expr> Parser::factor()
+Expr *Parser::unary()
 {
-    auto expr = unary();
-
-    while (match(TK_MathOperator))
-    {
-        std::string op_val = previous().value;
-        if (op_val == "*" || op_val == "/" || op_val == "%")
-        {
-            Token op = previous();
-            auto right = unary();
-            expr = std::make_unique<BinaryExpr>(op, std::move(expr), std::move(right));
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    return expr;
-}
-
-std::unique_ptr<Expr> Parser::unary()
-{
-    if (match(TK_LogicalOperator))
+    // '!' is the only prefix operator; "&&" and "||" share its token kind
+    if (check(TK_LogicalOperator) && tokens.text(current).size() == 1)
     {
+        advance();
         Token op = previous();
-        auto right = unary();
-        return std::make_unique<UnaryExpr>(op, std::move(right));
+        Expr *right = unary();
+        if (!right)
+            return nullptr;
+        return arena->make<UnaryExpr>(op, right);
     }
     return primary();
 }
 
-std::unique_ptr<Expr> Parser::primary()
+Expr *Parser::primary()
 {
-    if (match({TK_Integer, TK_Float, TK_String}))
+    if (match<TK_Integer, TK_Float, TK_String>())
     {
-        return std::make_unique<Literal>(previous());
+        return arena->make<Literal>(previous());
     }
 
     if (match(TK_Identifier))
     {
-        return std::make_unique<Identifier>(previous());
+        return arena->make<Identifier>(previous());
     }
 
     if (match(TK_OpenParen))
     {
-        auto expr = expression();
-        consume(TK_CloseParen, "Expected ')' after expression");
+        Expr *expr = expression();
+        if (!expr || !consume(TK_CloseParen, "Expected ')' after expression"))
+            return nullptr;
         return expr;
     }
 
     error(peek(), "Expected expression");
-    throw std::runtime_error("Expected expression");
+    return nullptr;
 }
 
-std::string Parser::printAST(const std::vector<std::unique_ptr<Stmt>> &statements)
+void printDiagnostics(const std::vector<Diagnostic> &diagnostics, const LineIndex &lines, std::ostream &out)
 {
-    ASTPrinter printer;
-    return printer.print(statements);
+    for (const Diagnostic &diagnostic : diagnostics)
+    {
+        SourcePosition position = lines.position(diagnostic.token.offset);
+        out << "[Line " << position.line << ":" << position.column << "] Error at '" << diagnostic.token.value
+            << "': " << diagnostic.message << '\n';
+    }
+    out.flush();
 }
 
-std::string ASTPrinter::print(const std::vector<std::unique_ptr<Stmt>> &statements)
+void Parser::printDiagnostics(const ParseResult &result, std::ostream &out) const
 {
-    std::string result = "Abstract Syntax Tree:\n";
-    for (const auto &stmt : statements)
-    {
-        result += printStmt(stmt.get()) + "\n";
-    }
-    return result;
+    ::printDiagnostics(result.diagnostics, lines, out);
 }
 
-std::string ASTPrinter::printStmt(const Stmt *stmt)
+std::string Parser::printAST(const ParseResult &result)
 {
-    if (const VarDeclaration *varDecl = dynamic_cast<const VarDeclaration *>(stmt))
-    {
-        std::string output = makeIndent() + "VarDeclaration: " + varDecl->type.value + " " + varDecl->name.value;
+    std::ostringstream out;
+    printAST(result, out);
+    return out.str();
+}
 
-        if (varDecl->initializer)
-        {
-            indentLevel++;
-            output += "\n" + makeIndent() + "Initializer: " + printExpr(varDecl->initializer.get());
-            indentLevel--;
-        }
+void Parser::printAST(const ParseResult &result, std::ostream &out)
+{
+    ASTPrinter printer(out);
+    printer.print(result.statements);
+}
 
-        return output;
-    }
-    else if (const ExprStmt *exprStmt = dynamic_cast<const ExprStmt *>(stmt))
+void ASTPrinter::print(const std::vector<Stmt *> &statements)
+{
+    out << "Abstract Syntax Tree:\n";
+    for (const Stmt *stmt : statements)
     {
-        std::string output = makeIndent() + "ExpressionStatement:";
-        if (exprStmt->expr)
-        {
-            indentLevel++;
-            output += "\n" + makeIndent() + printExpr(exprStmt->expr.get());
-            indentLevel--;
-        }
-        return output;
+        visit(stmt);
+        out << '\n';
     }
-
-    return makeIndent() + "Unknown Statement";
 }
 
-std::string ASTPrinter::printExpr(const Expr *expr)
+void ASTPrinter::visitVarDeclaration(const VarDeclaration *varDecl)
 {
-    if (const BinaryExpr *binary = dynamic_cast<const BinaryExpr *>(expr))
-    {
-        std::vector<const Expr *> exprs = {binary->left.get(), binary->right.get()};
-        return parenthesize(binary->op.value, exprs);
-    }
-    else if (const UnaryExpr *unary = dynamic_cast<const UnaryExpr *>(expr))
-    {
-        std::vector<const Expr *> exprs = {unary->right.get()};
-        return parenthesize(unary->op.value, exprs);
-    }
-    else if (const Literal *literal = dynamic_cast<const Literal *>(expr))
+    out.indent(indentLevel);
+    out << "VarDeclaration: " << varDecl->type.value << ' ' << varDecl->name.value;
+
+    if (varDecl->initializer)
     {
-        return "(literal " + literal->value.value + ")";
+        indentLevel++;
+        out << '\n';
+        out.indent(indentLevel);
+        out << "Initializer: ";
+        visit(varDecl->initializer);
+        indentLevel--;
     }
-    else if (const Identifier *ident = dynamic_cast<const Identifier *>(expr))
+}
+
+void ASTPrinter::visitExprStmt(const ExprStmt *exprStmt)
+{
+    out.indent(indentLevel);
+    out << "ExpressionStatement:";
+    if (exprStmt->expr)
     {
-        return "(id " + ident->name.value + ")";
+        indentLevel++;
+        out << '\n';
+        out.indent(indentLevel);
+        visit(exprStmt->expr);
+        indentLevel--;
     }
+}
 
-    return "(unknown_expr)";
+void ASTPrinter::visitBinary(const BinaryExpr *binary)
+{
+    parenthesize(binary->op.value, {binary->left, binary->right});
+}
+
+void ASTPrinter::visitUnary(const UnaryExpr *unary)
+{
+    parenthesize(unary->op.value, {unary->right});
+}
+
+void ASTPrinter::visitLiteral(const Literal *literal)
+{
+    out << "(literal " << literal->value.value << ')';
+}
+
+void ASTPrinter::visitIdentifier(const Identifier *ident)
+{
+    out << "(id " << ident->name.value << ')';
 }
 
-std::string ASTPrinter::parenthesize(const std::string &name, const std::vector<const Expr *> &exprs)
+void ASTPrinter::visitNull()
 {
-    std::string output = "(" + name;
+    out << "(unknown_expr)";
+}
 
+void ASTPrinter::parenthesize(std::string_view name, std::initializer_list<const Expr *> operands)
+{
+    out << '(' << name;
+
+    indentLevel++;
+    for (const Expr *expr : operands)
     {
-        indentLevel++;
-        for (const Expr *expr : exprs)
-        {
-            output += "\n" + makeIndent() + printExpr(expr);
-        }
-        indentLevel--;
+        out << '\n';
+        out.indent(indentLevel);
+        visit(expr);
     }
+    indentLevel--;
 
-    output += ")";
-    return output;
-}
\ No newline at end of file
+    out << ')';
+}
@@ -19,120 +19,247 @@ Copyright 2025-latest I. Mitterfellner
 #pragma once
 
 #include "tokens.hpp"
+#include "tokenstream.hpp"
+#include "lineindex.hpp"
+#include "arena.hpp"
+#include "outputsink.hpp"
 #include <vector>
 #include <memory>
-#include <stdexcept>
 #include <unordered_map>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <iomanip>
+#include <type_traits>
+#include <initializer_list>
 
 struct ASTNode;
 struct Expr;
 struct Stmt;
 
+enum NodeKind : uint8_t {
+    NK_VarDeclaration,
+    NK_ExprStmt,
+
+    NK_Binary,
+    NK_Unary,
+    NK_Literal,
+    NK_Identifier,
+};
+
+// AST nodes live in the Arena of the ParseResult that produced them and
+// are released with it in one go, so they only hold trivially destructible
+// members and refer to their children by plain pointer. There are no
+// virtual functions: `kind` says which node type this is, and passes
+// dispatch on it through ASTVisitor.
 struct ASTNode {
-    virtual ~ASTNode() = default;
+    NodeKind kind;
+
+protected:
+    explicit ASTNode(NodeKind kind) : kind(kind) {}
 };
 
 struct Expr : public ASTNode {
-    virtual ~Expr() = default;
+protected:
+    using ASTNode::ASTNode;
 };
 
 struct Stmt : public ASTNode {
-    virtual ~Stmt() = default;
+protected:
+    using ASTNode::ASTNode;
 };
 
 struct BinaryExpr : public Expr {
     Token op;
-    std::unique_ptr<Expr> left;
-    std::unique_ptr<Expr> right;
+    Expr* left;
+    Expr* right;
 
-    BinaryExpr(Token op, std::unique_ptr<Expr> left, std::unique_ptr<Expr> right)
-        : op(op), left(std::move(left)), right(std::move(right)) {}
+    BinaryExpr(Token op, Expr* left, Expr* right)
+        : Expr(NK_Binary), op(op), left(left), right(right) {}
 };
 
 struct UnaryExpr : public Expr {
     Token op;
-    std::unique_ptr<Expr> right;
+    Expr* right;
 
-    UnaryExpr(Token op, std::unique_ptr<Expr> right)
-        : op(op), right(std::move(right)) {}
+    UnaryExpr(Token op, Expr* right)
+        : Expr(NK_Unary), op(op), right(right) {}
 };
 
 struct Literal : public Expr {
     Token value;
 
-    explicit Literal(Token value) : value(value) {}
+    explicit Literal(Token value) : Expr(NK_Literal), value(value) {}
 };
 
 struct Identifier : public Expr {
     Token name;
 
-    explicit Identifier(Token name) : name(name) {}
+    explicit Identifier(Token name) : Expr(NK_Identifier), name(name) {}
 };
 
 struct VarDeclaration : public Stmt {
     Token type;
     Token name;
-    std::unique_ptr<Expr> initializer;
+    Expr* initializer;
 
-    VarDeclaration(Token type, Token name, std::unique_ptr<Expr> initializer)
-        : type(type), name(name), initializer(std::move(initializer)) {}
+    VarDeclaration(Token type, Token name, Expr* initializer)
+        : Stmt(NK_VarDeclaration), type(type), name(name), initializer(initializer) {}
 };
 
 struct ExprStmt : public Stmt {
-    std::unique_ptr<Expr> expr;
-    explicit ExprStmt(std::unique_ptr<Expr> expr) : expr(std::move(expr)) {}
+    Expr* expr;
+    explicit ExprStmt(Expr* expr) : Stmt(NK_ExprStmt), expr(expr) {}
+};
+
+static_assert(std::is_trivially_destructible<BinaryExpr>::value && std::is_trivially_destructible<VarDeclaration>::value,
+              "arena-allocated nodes are never destroyed");
+
+// Node dispatch for tree passes: one switch on the kind tag, then a static
+// call into the derived pass (CRTP), e.g.
+//
+//     class Counter : public ASTVisitor<Counter, int> {
+//     public:
+//         int visitBinary(const BinaryExpr* node) { return 1 + visit(node->left) + visit(node->right); }
+//         ...
+//     };
+//
+// A pass implements one visitX for every node type; null nodes go to
+// visitNull.
+template <typename Derived, typename Result = void>
+class ASTVisitor {
+public:
+    Result visit(const Stmt* stmt) {
+        if (!stmt)
+            return derived().visitNull();
+        switch (stmt->kind) {
+        case NK_VarDeclaration:
+            return derived().visitVarDeclaration(static_cast<const VarDeclaration*>(stmt));
+        case NK_ExprStmt:
+            return derived().visitExprStmt(static_cast<const ExprStmt*>(stmt));
+        default:
+            return derived().visitNull();
+        }
+    }
+
+    Result visit(const Expr* expr) {
+        if (!expr)
+            return derived().visitNull();
+        switch (expr->kind) {
+        case NK_Binary:
+            return derived().visitBinary(static_cast<const BinaryExpr*>(expr));
+        case NK_Unary:
+            return derived().visitUnary(static_cast<const UnaryExpr*>(expr));
+        case NK_Literal:
+            return derived().visitLiteral(static_cast<const Literal*>(expr));
+        case NK_Identifier:
+            return derived().visitIdentifier(static_cast<const Identifier*>(expr));
+        default:
+            return derived().visitNull();
+        }
+    }
+
+private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+// A syntax error. `message` always points at a string literal.
+struct Diagnostic {
+    Token token;
+    std::string_view message;
+};
+
+// Writes one "[Line l:c] Error at '...': message" line per diagnostic;
+// `lines` is the index of the source the diagnostics' tokens point into.
+void printDiagnostics(const std::vector<Diagnostic>& diagnostics, const LineIndex& lines, std::ostream& out);
+
+// Owns a parsed program: the top-level statements, the arena all of their
+// nodes were allocated from, and the errors found along the way. A
+// statement with an error in it is left out of `statements`.
+struct ParseResult {
+    Arena arena;
+    std::vector<Stmt*> statements;
+    std::vector<Diagnostic> diagnostics;
 };
 
 class Parser {
 public:
-    explicit Parser(std::vector<Token> tokens);
+    // `arenaBlockBytes` is the first block size of the result's arena.
+    Parser(TokenStream tokens, const LineIndex& lines, size_t arenaBlockBytes = 64 * 1024);
     
-    std::vector<std::unique_ptr<Stmt>> parse();
-    std::string printAST(const std::vector<std::unique_ptr<Stmt>>& statements);
+    ParseResult parse();
+
+    // Parses on up to `jobs` threads when the tokens are fully lexed; the
+    // result is identical to parse(). Defined in parallelparser.cpp.
+    ParseResult parse(unsigned jobs);
+    void printDiagnostics(const ParseResult& result, std::ostream& out) const;
+    std::string printAST(const ParseResult& result);
+    void printAST(const ParseResult& result, std::ostream& out);
     
 private:
     bool isAtEnd() const;
-    const Token& peek() const;
-    const Token& previous() const;
-    const Token& advance();
+    Token peek() const;
+    Token previous() const;
+    void advance();
     bool check(TokenKind type) const;
     bool match(TokenKind type);
-    bool match(const std::vector<TokenKind>& types);
+
+    // Matches any of `Kinds`; the set is a compile-time mask, e.g.
+    // match<TK_Integer, TK_Float>().
+    template <TokenKind... Kinds>
+    bool check() const {
+        return !isAtEnd() && ((tokenKindMask<Kinds...> >> tokens.kind(current)) & 1) != 0;
+    }
+
+    template <TokenKind... Kinds>
+    bool match() {
+        if (!check<Kinds...>())
+            return false;
+        advance();
+        return true;
+    }
     
-    Token consume(TokenKind type, const std::string& message);
-    void error(const Token& token, const std::string& message);
+    // Syntax errors never throw: they are recorded with error(), and the
+    // failing rule returns nullptr up to the statement, which resynchronizes.
+    bool consume(TokenKind type, std::string_view message);
+    void error(const Token& token, std::string_view message);
     void synchronize();
     
-    std::unique_ptr<Stmt> declaration();
-    std::unique_ptr<Stmt> varDeclaration();
-    std::unique_ptr<Stmt> statement();
-    std::unique_ptr<Expr> expression();
-    std::unique_ptr<Expr> equality();
-    std::unique_ptr<Expr> comparison();
-    std::unique_ptr<Expr> term();
-    std::unique_ptr<Expr> factor();
-    std::unique_ptr<Expr> unary();
-    std::unique_ptr<Expr> primary();
+    Stmt* declaration();
+    Stmt* varDeclaration();
+    Stmt* statement();
+    Expr* expression(uint8_t minPrecedence = 1);
+    uint8_t binaryPrecedence() const;
+    Expr* unary();
+    Expr* primary();
     
-    std::vector<Token> tokens;
+    TokenStream tokens;
+    Arena* arena = nullptr; // the arena of the result being built
+    const LineIndex& lines; // resolves token offsets for diagnostics
+    std::vector<Diagnostic> diagnostics;
+    size_t arenaBlockBytes;
     size_t current = 0;
 };
 
-class ASTPrinter {
+// Writes the tree straight into an OutputSink as it is walked, so a dump
+// takes time linear in its output and no memory beyond the sink's buffer.
+class ASTPrinter : public ASTVisitor<ASTPrinter> {
 public:
-    std::string print(const std::vector<std::unique_ptr<Stmt>>& statements);
+    explicit ASTPrinter(std::ostream& out) : out(out) {}
+
+    void print(const std::vector<Stmt*>& statements);
+
+    void visitVarDeclaration(const VarDeclaration* varDecl);
+    void visitExprStmt(const ExprStmt* exprStmt);
+    void visitBinary(const BinaryExpr* binary);
+    void visitUnary(const UnaryExpr* unary);
+    void visitLiteral(const Literal* literal);
+    void visitIdentifier(const Identifier* ident);
+    void visitNull();
     
 private:
-    std::string printStmt(const Stmt* stmt);
-    std::string printExpr(const Expr* expr);
-    std::string parenthesize(const std::string& name, const std::vector<const Expr*>& exprs);
+    void parenthesize(std::string_view name, std::initializer_list<const Expr*> operands);
     
+    OutputSink out;
     int indentLevel = 0;
-    
-    std::string makeIndent() {
-        return std::string(indentLevel * 2, ' ');
-    }
 };
\ No newline at end of file
@@ -48,6 +48,47 @@ flagsStruct handleRunArgs(int argc, char *argv[], std::string version)
         .help("Flag to enable advanced compile logs")
         .flag();
 
+    // ========= OPTIONS =========
+    program.add_argument("-lx", "--lexer")
+        .help("Lexer engine: \"hand\", \"dfa\", \"stream\" to lex on demand while parsing, or \"compare\" to time hand and dfa and check their token streams match")
+        .default_value(std::string{"hand"})
+        .choices("hand", "dfa", "stream", "compare");
+
+    program.add_argument("-j", "--jobs")
+        .help("Number of threads used to lex and parse the input, 0 picks one per hardware thread")
+        .default_value(1)
+        .scan<'i', int>();
+
+    program.add_argument("-ast", "--ast")
+        .help("AST representation to build and dump: \"tree\" (linked nodes) or \"flat\" (index-based node array)")
+        .default_value(std::string{"tree"})
+        .choices("tree", "flat");
+
+    program.add_argument("-ea", "--emit-ast")
+        .help("Also write the parsed AST to this path as a binary AST file")
+        .default_value(std::string{""});
+
+    program.add_argument("-la", "--load-ast")
+        .help("Flag to treat the input as a binary AST file written by --emit-ast and dump it without lexing or parsing")
+        .flag();
+
+    program.add_argument("-fc", "--frontend-cache")
+        .help("Flag to reuse the AST and diagnostics of an unchanged input from the front-end cache instead of lexing and parsing it")
+        .flag();
+
+    program.add_argument("--cache-dir")
+        .help("Directory of the front-end cache")
+        .default_value(std::string{".basl-cache"});
+
+    program.add_argument("--cache-size")
+        .help("Size limit of the front-end cache in MB; least recently used entries are evicted beyond it")
+        .default_value(256)
+        .scan<'i', int>();
+
+    program.add_argument("--cache-stats")
+        .help("Flag to print front-end cache hits, misses, evictions and size after the run")
+        .flag();
+
     try
     {
         program.parse_args(argc, argv);
@@ -65,7 +106,16 @@ flagsStruct handleRunArgs(int argc, char *argv[], std::string version)
         program.get<bool>("-w"),
         program.get<bool>("-cc"),
         program.get<bool>("-log"),
-        program.get<bool>("-alog")};
-
-    return flagsStruct{};
+        program.get<bool>("-alog"),
+        program.get<std::string>("-lx"),
+        program.get<int>("-j"),
+        program.get<std::string>("-ast"),
+        program.get<std::string>("-ea"),
+        program.get<bool>("-la"),
+        program.get<bool>("-fc"),
+        program.get<std::string>("--cache-dir"),
+        program.get<int>("--cache-size"),
+        program.get<bool>("--cache-stats")};
+
+    return returnFlagsStruct;
 }
\ No newline at end of file
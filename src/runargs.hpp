@@ -29,6 +29,15 @@ struct flagsStruct
     bool consoleColor = false;
     bool generalProccessLogs = false;
     bool advancedProccessLogs = false;
+    std::string lexerMode = "hand";
+    int jobs = 1;
+    std::string astFormat = "tree";
+    std::string emitASTPath = "";
+    bool loadAST = false;
+    bool useCache = false;
+    std::string cacheDir = ".basl-cache";
+    int cacheSizeMB = 256;
+    bool cacheStats = false;
 };
 
 flagsStruct handleRunArgs(int argc, char *argv[], std::string version);
\ No newline at end of file
@@ -0,0 +1,484 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "scan.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASL_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BASL_TARGET_AVX2
+#else
+#define BASL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// ========= SCALAR =========
+
+static size_t skipWhitespaceScalar(const char *data, size_t pos, size_t end)
+{
+    while (pos < end && hasCharClass(data[pos], CC_Space))
+        pos++;
+    return pos;
+}
+
+static size_t skipIdentifierScalar(const char *data, size_t pos, size_t end)
+{
+    while (pos < end && hasCharClass(data[pos], CC_Alpha | CC_Digit | CC_Underscore))
+        pos++;
+    return pos;
+}
+
+static size_t findStringSpecialScalar(const char *data, size_t pos, size_t end)
+{
+    while (pos < end && data[pos] != '"' && data[pos] != '\\')
+        pos++;
+    return pos;
+}
+
+static void collectLineStartsScalar(const char *data, size_t pos, size_t end, std::vector<uint32_t> &lineStarts)
+{
+    const char *cursor = data + pos;
+    const char *limit = data + end;
+    while ((cursor = static_cast<const char *>(std::memchr(cursor, '\n', limit - cursor))) != nullptr)
+    {
+        lineStarts.push_back(static_cast<uint32_t>(cursor - data + 1));
+        cursor++;
+    }
+}
+
+// Checks one sequence starting at a byte >= 0x80 against the well-formed
+// table of the Unicode standard (no overlongs, surrogates or values above
+// U+10FFFF). Returns its length, or 0 when it is malformed or truncated.
+static inline size_t utf8SequenceLength(const uint8_t *bytes, size_t pos, size_t size)
+{
+    uint8_t lead = bytes[pos];
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+    size_t length;
+
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        if (lead == 0xE0)
+            low = 0xA0;
+        else if (lead == 0xED)
+            high = 0x9F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        if (lead == 0xF0)
+            low = 0x90;
+        else if (lead == 0xF4)
+            high = 0x8F;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (pos + length > size || bytes[pos + 1] < low || bytes[pos + 1] > high)
+        return 0;
+    for (size_t i = 2; i < length; i++)
+    {
+        if ((bytes[pos + i] & 0xC0) != 0x80)
+            return 0;
+    }
+    return length;
+}
+
+static bool validateUTF8Scalar(const char *data, size_t size)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    size_t pos = 0;
+    while (pos < size)
+    {
+        if (pos + sizeof(uint64_t) <= size)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes + pos, sizeof(word));
+            if (!(word & 0x8080808080808080ull))
+            {
+                pos += sizeof(word);
+                continue;
+            }
+        }
+        if (bytes[pos] < 0x80)
+        {
+            pos++;
+            continue;
+        }
+        size_t length = utf8SequenceLength(bytes, pos, size);
+        if (length == 0)
+            return false;
+        pos += length;
+    }
+    return true;
+}
+
+#ifdef BASL_SCAN_X86
+
+static inline int countTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// newline offsets are recovered from the set bits of `newlines`, each bit
+// standing for the byte at `base + bit`
+static inline void appendLineStarts(uint32_t newlines, size_t base, std::vector<uint32_t> &lineStarts)
+{
+    while (newlines)
+    {
+        lineStarts.push_back(static_cast<uint32_t>(base + countTrailingZeros(newlines) + 1));
+        newlines &= newlines - 1;
+    }
+}
+
+// ========= SSE2 =========
+
+// unsigned (v - low) <= span, i.e. low <= v <= low + span
+static inline __m128i inRange128(__m128i v, char low, char span)
+{
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+static size_t skipWhitespaceSSE2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 16 <= end)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), inRange128(v, '\t', '\r' - '\t'));
+        uint32_t spaceMask = static_cast<uint32_t>(_mm_movemask_epi8(space));
+
+        if (spaceMask != 0xFFFF)
+            return pos + countTrailingZeros(~spaceMask);
+        pos += 16;
+    }
+    return skipWhitespaceScalar(data, pos, end);
+}
+
+static size_t skipIdentifierSSE2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 16 <= end)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i alpha = inRange128(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z' - 'a');
+        __m128i digit = inRange128(v, '0', '9' - '0');
+        __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), underscore)));
+
+        if (mask != 0xFFFF)
+            return pos + countTrailingZeros(~mask);
+        pos += 16;
+    }
+    return skipIdentifierScalar(data, pos, end);
+}
+
+static size_t findStringSpecialSSE2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 16 <= end)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+
+        if (mask)
+            return pos + countTrailingZeros(mask);
+        pos += 16;
+    }
+    return findStringSpecialScalar(data, pos, end);
+}
+
+static void collectLineStartsSSE2(const char *data, size_t pos, size_t end, std::vector<uint32_t> &lineStarts)
+{
+    for (; pos + 16 <= end; pos += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        appendLineStarts(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))), pos, lineStarts);
+    }
+    collectLineStartsScalar(data, pos, end, lineStarts);
+}
+
+static bool validateUTF8SSE2(const char *data, size_t size)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    size_t pos = 0;
+    while (pos < size)
+    {
+        if (pos + 16 <= size)
+        {
+            uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + pos))));
+            if (high == 0)
+            {
+                pos += 16;
+                continue;
+            }
+            pos += countTrailingZeros(high);
+        }
+        else if (bytes[pos] < 0x80)
+        {
+            pos++;
+            continue;
+        }
+        size_t length = utf8SequenceLength(bytes, pos, size);
+        if (length == 0)
+            return false;
+        pos += length;
+    }
+    return true;
+}
+
+// ========= AVX2 =========
+
+BASL_TARGET_AVX2 static inline __m256i inRange256(__m256i v, char low, char span)
+{
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+BASL_TARGET_AVX2 static size_t skipWhitespaceAVX2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 32 <= end)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), inRange256(v, '\t', '\r' - '\t'));
+        uint32_t spaceMask = static_cast<uint32_t>(_mm256_movemask_epi8(space));
+
+        if (spaceMask != 0xFFFFFFFFu)
+            return pos + countTrailingZeros(~spaceMask);
+        pos += 32;
+    }
+    return skipWhitespaceSSE2(data, pos, end);
+}
+
+BASL_TARGET_AVX2 static size_t skipIdentifierAVX2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 32 <= end)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+        __m256i alpha = inRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z' - 'a');
+        __m256i digit = inRange256(v, '0', '9' - '0');
+        __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit), underscore)));
+
+        if (mask != 0xFFFFFFFFu)
+            return pos + countTrailingZeros(~mask);
+        pos += 32;
+    }
+    return skipIdentifierSSE2(data, pos, end);
+}
+
+BASL_TARGET_AVX2 static size_t findStringSpecialAVX2(const char *data, size_t pos, size_t end)
+{
+    while (pos + 32 <= end)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+
+        if (mask)
+            return pos + countTrailingZeros(mask);
+        pos += 32;
+    }
+    return findStringSpecialSSE2(data, pos, end);
+}
+
+// 64 bytes per iteration, so sparse newlines cost two compares and one test
+BASL_TARGET_AVX2 static void collectLineStartsAVX2(const char *data, size_t pos, size_t end, std::vector<uint32_t> &lineStarts)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; pos + 64 <= end; pos += 64)
+    {
+        __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos)), newline);
+        __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos + 32)), newline);
+        if (_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high)))
+            continue;
+        appendLineStarts(static_cast<uint32_t>(_mm256_movemask_epi8(low)), pos, lineStarts);
+        appendLineStarts(static_cast<uint32_t>(_mm256_movemask_epi8(high)), pos + 32, lineStarts);
+    }
+    collectLineStartsSSE2(data, pos, end, lineStarts);
+}
+
+// UTF-8 validation with the lookup algorithm of Keiser and Lemire
+// ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021). Each byte
+// is classified by the high and low nibble of its predecessor and its own
+// high nibble through three 16-entry shuffle tables; the AND of the three
+// lookups is non-zero exactly where a two-byte error pattern occurs. Bytes
+// that must be the 3rd/4th byte of a sequence are checked separately.
+
+template <int N>
+BASL_TARGET_AVX2 static inline __m256i previousBytes(__m256i input, __m256i previous)
+{
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+BASL_TARGET_AVX2 static inline __m256i highNibbles(__m256i v)
+{
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+BASL_TARGET_AVX2 static inline void checkUTF8Block(__m256i input, __m256i &previous, __m256i &previousIncomplete, __m256i &error)
+{
+    if (_mm256_movemask_epi8(input) == 0)
+    {
+        error = _mm256_or_si256(error, previousIncomplete);
+        previousIncomplete = _mm256_setzero_si256();
+        previous = input;
+        return;
+    }
+
+    const char tooShort = 1 << 0;
+    const char tooLong = 1 << 1;
+    const char overlong3 = 1 << 2;
+    const char tooLarge = 1 << 3;
+    const char surrogate = 1 << 4;
+    const char overlong2 = 1 << 5;
+    const char tooLarge1000 = 1 << 6;
+    const char overlong4 = 1 << 6;
+    const char twoContinuations = static_cast<char>(1 << 7);
+    const char carry = tooShort | tooLong | twoContinuations;
+
+    const __m256i byte1HighTable = _mm256_setr_epi8(
+        tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+        twoContinuations, twoContinuations, twoContinuations, twoContinuations,
+        tooShort | overlong2, tooShort, tooShort | overlong3 | surrogate,
+        tooShort | tooLarge | tooLarge1000 | overlong4,
+        tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+        twoContinuations, twoContinuations, twoContinuations, twoContinuations,
+        tooShort | overlong2, tooShort, tooShort | overlong3 | surrogate,
+        tooShort | tooLarge | tooLarge1000 | overlong4);
+
+    const char large = carry | tooLarge | tooLarge1000;
+    const __m256i byte1LowTable = _mm256_setr_epi8(
+        carry | overlong3 | overlong2 | overlong4, carry | overlong2, carry, carry,
+        carry | tooLarge, large, large, large, large, large, large, large, large,
+        large | surrogate, large, large,
+        carry | overlong3 | overlong2 | overlong4, carry | overlong2, carry, carry,
+        carry | tooLarge, large, large, large, large, large, large, large, large,
+        large | surrogate, large, large);
+
+    const char continuation = tooLong | overlong2 | twoContinuations;
+    const __m256i byte2HighTable = _mm256_setr_epi8(
+        tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+        continuation | overlong3 | tooLarge1000 | overlong4, continuation | overlong3 | tooLarge,
+        continuation | surrogate | tooLarge, continuation | surrogate | tooLarge,
+        tooShort, tooShort, tooShort, tooShort,
+        tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+        continuation | overlong3 | tooLarge1000 | overlong4, continuation | overlong3 | tooLarge,
+        continuation | surrogate | tooLarge, continuation | surrogate | tooLarge,
+        tooShort, tooShort, tooShort, tooShort);
+
+    __m256i prev1 = previousBytes<1>(input, previous);
+    __m256i specialCases = _mm256_and_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(byte1HighTable, highNibbles(prev1)),
+                         _mm256_shuffle_epi8(byte1LowTable, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+        _mm256_shuffle_epi8(byte2HighTable, highNibbles(input)));
+
+    // only 111_____ leads can require a third byte, only 1111____ a fourth
+    __m256i prev2 = previousBytes<2>(input, previous);
+    __m256i prev3 = previousBytes<3>(input, previous);
+    __m256i mustContinue = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+                                           _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80))));
+    __m256i mustContinue80 = _mm256_and_si256(mustContinue, _mm256_set1_epi8(static_cast<char>(0x80)));
+    error = _mm256_or_si256(error, _mm256_xor_si256(mustContinue80, specialCases));
+
+    // a lead byte in the last three positions that still needs more bytes
+    const __m256i maxValue = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    previousIncomplete = _mm256_subs_epu8(input, maxValue);
+    previous = input;
+}
+
+BASL_TARGET_AVX2 static bool validateUTF8AVX2(const char *data, size_t size)
+{
+    __m256i previous = _mm256_setzero_si256();
+    __m256i previousIncomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+
+    size_t pos = 0;
+    for (; pos + 32 <= size; pos += 32)
+    {
+        checkUTF8Block(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos)), previous, previousIncomplete, error);
+    }
+    if (pos < size)
+    {
+        // zero padding reads as ASCII, so it also flags a truncated final sequence
+        char tail[32] = {};
+        std::memcpy(tail, data + pos, size - pos);
+        checkUTF8Block(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(tail)), previous, previousIncomplete, error);
+    }
+    error = _mm256_or_si256(error, previousIncomplete);
+
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+static bool cpuHasAVX2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // BASL_SCAN_X86
+
+const ScanKernels &scalarScanKernels()
+{
+    static const ScanKernels kernels = {skipWhitespaceScalar, skipIdentifierScalar, findStringSpecialScalar, collectLineStartsScalar, validateUTF8Scalar, "scalar"};
+    return kernels;
+}
+
+const ScanKernels &scanKernels()
+{
+#ifdef BASL_SCAN_X86
+    static const ScanKernels sse2 = {skipWhitespaceSSE2, skipIdentifierSSE2, findStringSpecialSSE2, collectLineStartsSSE2, validateUTF8SSE2, "sse2"};
+    static const ScanKernels avx2 = {skipWhitespaceAVX2, skipIdentifierAVX2, findStringSpecialAVX2, collectLineStartsAVX2, validateUTF8AVX2, "avx2"};
+    static const ScanKernels &selected = cpuHasAVX2() ? avx2 : sse2;
+    return selected;
+#else
+    return scalarScanKernels();
+#endif
+}
@@ -0,0 +1,88 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ASCII character classes used by the lexer. They match the "C" locale
+// behaviour of std::isspace/std::isalpha/std::isalnum/std::isdigit without
+// the locale lookup, and classify every byte >= 0x80 as "other".
+enum CharClass : uint8_t
+{
+    CC_Space = 1 << 0,
+    CC_Alpha = 1 << 1,
+    CC_Digit = 1 << 2,
+    CC_Underscore = 1 << 3,
+};
+
+constexpr std::array<uint8_t, 256> buildCharClassTable()
+{
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; c++)
+    {
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+            table[c] |= CC_Space;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+            table[c] |= CC_Alpha;
+        if (c >= '0' && c <= '9')
+            table[c] |= CC_Digit;
+        if (c == '_')
+            table[c] |= CC_Underscore;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> charClassTable = buildCharClassTable();
+
+inline bool hasCharClass(char c, uint8_t classes)
+{
+    return (charClassTable[static_cast<unsigned char>(c)] & classes) != 0;
+}
+
+// Bulk scanners used by the lexer's hot loops and by file loading. Each one starts at `pos` and
+// returns the first offset in [pos, end] where the scanned run stops.
+struct ScanKernels
+{
+    // Skips whitespace.
+    size_t (*skipWhitespace)(const char *data, size_t pos, size_t end);
+
+    // Skips [A-Za-z0-9_].
+    size_t (*skipIdentifier)(const char *data, size_t pos, size_t end);
+
+    // Stops at the next '"' or '\\' inside a string literal body.
+    size_t (*findStringSpecial)(const char *data, size_t pos, size_t end);
+
+    // Appends the offset following every '\n' in [pos, end) to `lineStarts`.
+    void (*collectLineStarts)(const char *data, size_t pos, size_t end, std::vector<uint32_t> &lineStarts);
+
+    // True if [data, data + size) is well-formed UTF-8.
+    bool (*validateUTF8)(const char *data, size_t size);
+
+    const char *name;
+};
+
+// Picks the widest kernel set the running CPU supports (AVX2, SSE2, scalar).
+// The choice is made once, on first call.
+const ScanKernels &scanKernels();
+
+// The portable fallback, also used to cross-check the vector kernels.
+const ScanKernels &scalarScanKernels();
@@ -0,0 +1,44 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "lineindex.hpp"
+#include "mappedfile.hpp"
+#include <string>
+#include <string_view>
+
+// Owns the bytes of a single input file, either as a read-only mapping or,
+// for inputs that can not be mapped, as `content`. Tokens and AST nodes only
+// hold views into text(), so a SourceFile has to outlive both lexing and parsing.
+// The line index is built once on construction and answers every
+// offset -> line/column query afterwards.
+struct SourceFile
+{
+    SourceFile(std::string path, std::string content, MappedFile mapping = MappedFile())
+        : path(std::move(path)), content(std::move(content)), mapping(std::move(mapping)), lines(text()) {}
+
+    std::string path;
+    std::string content;
+    MappedFile mapping;
+    LineIndex lines;
+
+    std::string_view text() const { return mapping.isMapped() ? mapping.view() : std::string_view(content); }
+    size_t size() const { return text().size(); }
+    SourcePosition position(uint32_t offset) const { return lines.position(offset); }
+};
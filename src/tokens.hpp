@@ -17,7 +17,11 @@ Copyright 2025-latest I. Mitterfellner
 */
 
 #pragma once
-#include <string>
+#include "interner.hpp"
+#include <cassert>
+#include <cstdint>
+#include <string_view>
+#include <vector>
 
 enum TokenKind
 {
@@ -57,11 +61,96 @@ enum TokenKind
     TK_EOF // End of file
 };
 
+static_assert(TK_EOF < 64, "token kinds must fit a TokenKindMask");
+
+// A set of token kinds with one bit per kind, so that membership is a
+// single shift-and-test.
+using TokenKindMask = uint64_t;
+
+template <TokenKind... Kinds>
+inline constexpr TokenKindMask tokenKindMask = ((TokenKindMask{1} << Kinds) | ...);
+
+// Only identifiers are interned by the lexer; names repeat throughout a
+// program, literals mostly do not. Every other kind carries NoSymbol.
+inline bool isInternedKind(TokenKind kind)
+{
+    return kind == TK_Identifier;
+}
+
+// Line and column are not stored; resolve `offset` through the source's
+// LineIndex when a position is needed.
 struct Token
 {
     TokenKind type;
-    std::string value;
-    int line;
-    int start_column;
-    int end_column;
-};
\ No newline at end of file
+    std::string_view value; // view into the owning SourceFile
+    uint32_t offset;
+    Symbol symbol;
+};
+
+// Offsets and lengths are 32-bit, so no source may be larger than this;
+// readFile rejects bigger inputs before they reach a lexer.
+constexpr uint64_t maxSourceBytes = UINT32_MAX;
+
+// Packed lexer output. Each token is a kind byte plus a 32-bit offset and
+// length into the source, stored as parallel arrays so that the parser's
+// peek/check loop only walks the `kinds` array.
+class TokenBuffer
+{
+public:
+    TokenBuffer() = default;
+    explicit TokenBuffer(std::string_view source) : source(source) { assert(source.size() <= maxSourceBytes); }
+
+    void push(TokenKind kind, uint32_t offset, uint32_t length, Symbol symbol = NoSymbol)
+    {
+        kinds.push_back(static_cast<uint8_t>(kind));
+        offsets.push_back(offset);
+        lengths.push_back(length);
+        symbols.push_back(symbol);
+    }
+
+    // appends tokens [first, last) of a buffer lexed from the same source
+    void append(const TokenBuffer &other, size_t first, size_t last)
+    {
+        kinds.insert(kinds.end(), other.kinds.begin() + first, other.kinds.begin() + last);
+        offsets.insert(offsets.end(), other.offsets.begin() + first, other.offsets.begin() + last);
+        lengths.insert(lengths.end(), other.lengths.begin() + first, other.lengths.begin() + last);
+        symbols.insert(symbols.end(), other.symbols.begin() + first, other.symbols.begin() + last);
+    }
+
+    void append(const TokenBuffer &other, size_t first) { append(other, first, other.size()); }
+
+    // drops tokens [0, count), used by TokenStream to slide its window
+    void discardBefore(size_t count)
+    {
+        kinds.erase(kinds.begin(), kinds.begin() + count);
+        offsets.erase(offsets.begin(), offsets.begin() + count);
+        lengths.erase(lengths.begin(), lengths.begin() + count);
+        symbols.erase(symbols.begin(), symbols.begin() + count);
+    }
+
+    std::string_view sourceText() const { return source; }
+    size_t size() const { return kinds.size(); }
+    bool empty() const { return kinds.empty(); }
+
+    TokenKind kind(size_t index) const { return static_cast<TokenKind>(kinds[index]); }
+    uint32_t offset(size_t index) const { return offsets[index]; }
+    uint32_t length(size_t index) const { return lengths[index]; }
+    Symbol symbol(size_t index) const { return symbols[index]; }
+    std::string_view text(size_t index) const { return source.substr(offsets[index], lengths[index]); }
+
+    bool operator==(const TokenBuffer &other) const
+    {
+        return kinds == other.kinds && offsets == other.offsets && lengths == other.lengths &&
+               symbols == other.symbols;
+    }
+    bool operator!=(const TokenBuffer &other) const { return !(*this == other); }
+
+    Token operator[](size_t index) const { return {kind(index), text(index), offsets[index], symbols[index]}; }
+
+private:
+    std::string_view source;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<Symbol> symbols;
+};
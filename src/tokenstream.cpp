@@ -0,0 +1,50 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "tokenstream.hpp"
+#include "lexer.hpp"
+#include "log.hpp"
+#include <algorithm>
+
+TokenStream::TokenStream(TokenBuffer tokens) : window(std::move(tokens)) {}
+
+TokenStream::TokenStream(const SourceFile &source, size_t sliceBytes)
+    : window(source.text()), finished(false), input(source.text()), sliceBytes(sliceBytes)
+{
+    seek(0);
+}
+
+void TokenStream::refill(size_t index)
+{
+    // keep the token before `index` so the parser can still read previous()
+    size_t keepFrom = std::min(index > 0 ? index - 1 - base : 0, window.size());
+    window.discardBefore(keepFrom);
+    base += keepFrom;
+
+    while (index >= base + window.size() && lexPos < input.size())
+    {
+        BASL_LOG_TRACE("[Lexer] Lexing slice at byte " << lexPos);
+        lexPos = lexRange(input, lexPos, std::min(lexPos + sliceBytes, input.size()), window);
+    }
+
+    if (lexPos >= input.size() && index >= base + window.size())
+    {
+        window.push(TK_EOF, static_cast<uint32_t>(lexPos), 0);
+        finished = true;
+    }
+}
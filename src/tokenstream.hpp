@@ -0,0 +1,62 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include "tokens.hpp"
+#include "source.hpp"
+#include <string_view>
+
+// What the parser reads tokens through. A TokenStream either wraps a fully
+// lexed TokenBuffer or lexes the source on demand, a slice at a time, into
+// a small window that only keeps the tokens the parser can still look at
+// (the current one and the one before it). In the on-demand mode memory
+// use is bounded by the slice size instead of the token count.
+class TokenStream
+{
+public:
+    explicit TokenStream(TokenBuffer tokens);
+    explicit TokenStream(const SourceFile &source, size_t sliceBytes = 16 * 1024);
+
+    // Makes tokens `index` and `index - 1` readable. Indices must not go
+    // backwards by more than one; earlier tokens may already be discarded.
+    void seek(size_t index)
+    {
+        if (index >= base + window.size() && !finished)
+            refill(index);
+    }
+
+    TokenKind kind(size_t index) const { return window.kind(index - base); }
+    std::string_view text(size_t index) const { return window.text(index - base); }
+    Token operator[](size_t index) const { return window[index - base]; }
+
+    // The whole token buffer once every token up to EOF is held at once,
+    // which is always the case for a stream built from a TokenBuffer.
+    const TokenBuffer *buffered() const { return finished && base == 0 ? &window : nullptr; }
+
+private:
+    void refill(size_t index);
+
+    TokenBuffer window;
+    size_t base = 0; // stream index of window[0]
+    bool finished = true;
+
+    std::string_view input;
+    size_t lexPos = 0;
+    size_t sliceBytes = 0;
+};
@@ -0,0 +1,173 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "unicode.hpp"
+#include "scan.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASL_UNICODE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+bool validateUTF8(std::string_view bytes)
+{
+    return scanKernels().validateUTF8(bytes.data(), bytes.size());
+}
+
+static inline char *encodeUTF8(uint32_t codePoint, char *out)
+{
+    if (codePoint < 0x80)
+    {
+        *out++ = static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        *out++ = static_cast<char>(0xC0 | (codePoint >> 6));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *out++ = static_cast<char>(0xE0 | (codePoint >> 12));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        *out++ = static_cast<char>(0xF0 | (codePoint >> 18));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    return out;
+}
+
+static inline uint32_t readUnit16(const unsigned char *p, bool bigEndian)
+{
+    return bigEndian ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+}
+
+static inline uint32_t readUnit32(const unsigned char *p, bool bigEndian)
+{
+    return bigEndian ? (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                     : p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+bool transcodeUTF16ToUTF8(std::string_view bytes, bool bigEndian, std::string &out)
+{
+    if (bytes.size() % 2)
+        return false;
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(bytes.data());
+    const size_t units = bytes.size() / 2;
+    size_t i = 0;
+    if (units > 0 && readUnit16(data, bigEndian) == 0xFEFF)
+        i = 1;
+
+    // every UTF-16 unit becomes at most three UTF-8 bytes
+    out.resize(units * 3);
+    char *write = out.data();
+
+    while (i < units)
+    {
+#ifdef BASL_UNICODE_SSE2
+        // eight ASCII units at a time, narrowed with one pack
+        if (i + 8 <= units)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 2));
+            if (bigEndian)
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            __m128i nonASCII = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonASCII, _mm_setzero_si128())) == 0xFFFF)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(write), _mm_packus_epi16(v, v));
+                write += 8;
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        uint32_t unit = readUnit16(data + i * 2, bigEndian);
+        i++;
+        if (unit >= 0xD800 && unit <= 0xDBFF)
+        {
+            if (i == units)
+                return false;
+            uint32_t low = readUnit16(data + i * 2, bigEndian);
+            if (low < 0xDC00 || low > 0xDFFF)
+                return false;
+            i++;
+            unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if (unit >= 0xDC00 && unit <= 0xDFFF)
+        {
+            return false;
+        }
+        write = encodeUTF8(unit, write);
+    }
+
+    out.resize(write - out.data());
+    return true;
+}
+
+bool transcodeUTF32ToUTF8(std::string_view bytes, bool bigEndian, std::string &out)
+{
+    if (bytes.size() % 4)
+        return false;
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(bytes.data());
+    const size_t units = bytes.size() / 4;
+    size_t i = 0;
+    if (units > 0 && readUnit32(data, bigEndian) == 0xFEFF)
+        i = 1;
+
+    out.resize(units * 4);
+    char *write = out.data();
+
+    while (i < units)
+    {
+#ifdef BASL_UNICODE_SSE2
+        if (i + 4 <= units)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+            // in either byte order an ASCII unit has its value in one byte and zeros elsewhere
+            __m128i valueMask = bigEndian ? _mm_set1_epi32(static_cast<int>(0x7F000000)) : _mm_set1_epi32(0x7F);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_andnot_si128(valueMask, v), _mm_setzero_si128())) == 0xFFFF)
+            {
+                if (bigEndian)
+                    v = _mm_srli_epi32(v, 24);
+                __m128i narrow = _mm_packs_epi32(v, v);
+                int packed = _mm_cvtsi128_si32(_mm_packus_epi16(narrow, narrow));
+                std::memcpy(write, &packed, 4);
+                write += 4;
+                i += 4;
+                continue;
+            }
+        }
+#endif
+        uint32_t codePoint = readUnit32(data + i * 4, bigEndian);
+        i++;
+        if (codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+            return false;
+        write = encodeUTF8(codePoint, write);
+    }
+
+    out.resize(write - out.data());
+    return true;
+}
@@ -0,0 +1,32 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// True if the whole buffer is well-formed UTF-8, using the widest scan kernel
+// the CPU supports.
+bool validateUTF8(std::string_view bytes);
+
+// Transcode a UTF-16/UTF-32 buffer into UTF-8, replacing `out`. A leading
+// byte order mark is dropped. Returns false on a truncated code unit, an
+// unpaired surrogate or a code point above U+10FFFF.
+bool transcodeUTF16ToUTF8(std::string_view bytes, bool bigEndian, std::string &out);
+bool transcodeUTF32ToUTF8(std::string_view bytes, bool bigEndian, std::string &out);
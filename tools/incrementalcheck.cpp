@@ -0,0 +1,211 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+
+Checks IncrementalDocument against a full lex and parse.
+
+    incrementalcheck [edits] [seed]
+        Applies random edits to a random document and, after every edit,
+        compares the text, the line count, the AST dump and the diagnostics
+        (with line and column) against a full parse of the same text.
+        Exits with 1 on the first mismatch. Run by ctest.
+
+    incrementalcheck --latency [lines]
+        Types a statement into the middle of a `lines` line document one
+        key at a time and prints the median and p99 time per keystroke,
+        next to the time of a full lex and parse.
+
+*/
+
+#include "incremental.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Statements and fragments the generator draws from. The fragments are the
+// edits that move segment boundaries: ';', quotes that run on, braces.
+static const char *const statements[] = {
+    "int x = -5;\n", "float y = -3.14;\n", "\"hello\";\n", "x;\n", "(x == -1);\n", "!x;\n", "y = x * -2;\n",
+};
+
+static const char *const fragments[] = {
+    ";", "\"", "{", "}", "(", ")", "int ", "x", " ", "\n", "-1", "== ", "*", "= ", "'a'",
+};
+
+template <typename T, size_t N>
+static const char *pick(std::mt19937 &random, T (&pool)[N])
+{
+    return pool[std::uniform_int_distribution<size_t>(0, N - 1)(random)];
+}
+
+static std::string randomDocument(std::mt19937 &random, size_t lines)
+{
+    std::string text;
+    for (size_t i = 0; i < lines; i++)
+    {
+        text += pick(random, statements);
+    }
+    return text;
+}
+
+static std::string dumpAST(const std::vector<Stmt *> &statements)
+{
+    std::ostringstream out;
+    {
+        ASTPrinter printer(out);
+        printer.print(statements);
+    }
+    return out.str();
+}
+
+static std::string dumpDiagnostics(const std::vector<Diagnostic> &diagnostics, const LineIndex &lines)
+{
+    std::ostringstream out;
+    printDiagnostics(diagnostics, lines, out);
+    return out.str();
+}
+
+static bool matchesFullParse(const IncrementalDocument &document, const std::string &expected, size_t edit)
+{
+    if (document.text() != expected)
+    {
+        std::cerr << "edit " << edit << ": text differs" << std::endl;
+        return false;
+    }
+
+    SourceFile source{"", expected};
+    Parser parser(TokenStream(lex(source)), source.lines);
+    ParseResult full = parser.parse();
+
+    if (document.lines().lineCount() != source.lines.lineCount())
+    {
+        std::cerr << "edit " << edit << ": line count " << document.lines().lineCount() << ", expected "
+                  << source.lines.lineCount() << std::endl;
+        return false;
+    }
+    if (dumpAST(document.statements()) != dumpAST(full.statements))
+    {
+        std::cerr << "edit " << edit << ": AST differs" << std::endl;
+        return false;
+    }
+    if (dumpDiagnostics(document.diagnostics(), document.lines()) != dumpDiagnostics(full.diagnostics, source.lines))
+    {
+        std::cerr << "edit " << edit << ": diagnostics differ" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static int checkRandomEdits(size_t edits, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::string expected = randomDocument(random, 200);
+    IncrementalDocument document(expected);
+
+    for (size_t edit = 1; edit <= edits; edit++)
+    {
+        size_t offset = std::uniform_int_distribution<size_t>(0, expected.size())(random);
+        size_t removed = 0;
+        std::string inserted;
+        switch (random() % 4)
+        {
+        case 0: // delete a few bytes
+            removed = std::min<size_t>(random() % 8 + 1, expected.size() - offset);
+            break;
+        case 1: // replace a few bytes
+            removed = std::min<size_t>(random() % 4, expected.size() - offset);
+            inserted = pick(random, fragments);
+            break;
+        case 2: // paste whole statements
+            inserted = randomDocument(random, random() % 3 + 1);
+            break;
+        default: // type a fragment
+            inserted = pick(random, fragments);
+            break;
+        }
+
+        expected.replace(offset, removed, inserted);
+        document.applyEdit(offset, removed, inserted);
+        if (!matchesFullParse(document, expected, edit))
+        {
+            std::cerr << "seed " << seed << ", offset " << offset << ", removed " << removed << ", inserted '"
+                      << inserted << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << edits << " edits matched a full parse, " << document.segmentCount() << " segments" << std::endl;
+    return 0;
+}
+
+static int measureLatency(size_t lines)
+{
+    using clock = std::chrono::steady_clock;
+    std::mt19937 random(1);
+    std::string text = randomDocument(random, lines);
+
+    auto openStart = clock::now();
+    IncrementalDocument document(text);
+    auto openEnd = clock::now();
+
+    SourceFile source{"", text};
+    Parser parser(TokenStream(lex(source)), source.lines);
+    ParseResult full = parser.parse();
+    auto fullEnd = clock::now();
+
+    // typed at the start of a line in the middle of the document
+    size_t offset = text.find('\n', text.size() / 2) + 1;
+    std::string typed = "int typed = -42;\n";
+    std::vector<double> keystrokes;
+    for (char key : typed)
+    {
+        auto start = clock::now();
+        document.applyEdit(offset++, 0, std::string_view(&key, 1));
+        keystrokes.push_back(std::chrono::duration<double, std::micro>(clock::now() - start).count());
+    }
+    std::sort(keystrokes.begin(), keystrokes.end());
+
+    std::cout << lines << " lines, " << text.size() << " bytes, " << full.statements.size() << " statements\n"
+              << "keystroke: median " << keystrokes[keystrokes.size() / 2] << " us, p99 "
+              << keystrokes[keystrokes.size() * 99 / 100] << " us\n"
+              << "full lex + parse: " << std::chrono::duration<double, std::milli>(fullEnd - openEnd).count()
+              << " ms, initial open: " << std::chrono::duration<double, std::milli>(openEnd - openStart).count()
+              << " ms" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--latency")
+    {
+        return measureLatency(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000);
+    }
+
+    size_t edits = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 3000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    return checkRandomEdits(edits, seed);
+}
@@ -0,0 +1,172 @@
+/*
+
+Copyright 2025-latest I. Mitterfellner
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+
+Parser benchmarks on generated inputs. Inputs are lexed once up front;
+only Parser::parse is timed, best of 5.
+
+    parsebench scaling [statements...]
+        'int vN = a * -3 == b / c;' / 'vN;' pairs, 10k, 100k and 1M
+        statements by default. Time per statement stays flat when parse
+        time grows linearly with the statement count.
+
+    parsebench malformed [lines...]
+        Lines of 1 to 8 random tokens, 300k lines by default; most of
+        them are syntax errors, which times error recovery.
+
+    parsebench <file>
+        Parses an existing source file, e.g. one written with --write.
+
+    parsebench scaling|malformed --write <file> <count>
+        Writes the generated input instead of timing it, for runs of the
+        Bassil binary itself.
+
+*/
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::string wellFormedStatements(size_t count)
+{
+    std::string text;
+    text.reserve(count * 20);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i % 2 == 0)
+            text += "int v" + std::to_string(i) + " = a * -3 == b / c;\n";
+        else
+            text += "v" + std::to_string(i - 1) + ";\n";
+    }
+    return text;
+}
+
+static std::string malformedLines(size_t count)
+{
+    static const char *const tokens[] = {
+        "x",   "value", "-1", "-2.5", "\"text\"", "'c'", "int", "float", "char", "string", "bool", "if",
+        "else", "for",  "function", "return", "print", "+", "-", "*", "/", "%", "==", "!=", "<", ">=",
+        "&&",  "||",    "!",  "=",    ";",       ";",   "(",   ")",     "{",    "}",      ",",
+    };
+    constexpr size_t tokenCount = sizeof(tokens) / sizeof(tokens[0]);
+
+    // fixed seed, so every run parses the same corpus
+    std::mt19937 random(21);
+    std::string text;
+    for (size_t line = 0; line < count; line++)
+    {
+        size_t length = random() % 8 + 1;
+        for (size_t i = 0; i < length; i++)
+        {
+            text += tokens[random() % tokenCount];
+            text += ' ';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+// Best of 5 parses of `text`, in milliseconds.
+static double timeParse(const std::string &text, size_t &statements, size_t &errors)
+{
+    SourceFile source{"", text};
+    TokenBuffer tokens = lex(source);
+
+    double best = 0;
+    for (int run = 0; run < 5; run++)
+    {
+        Parser parser(TokenStream(tokens), source.lines);
+        auto start = std::chrono::steady_clock::now();
+        ParseResult result = parser.parse();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+        statements = result.statements.size();
+        errors = result.diagnostics.size();
+    }
+    return best;
+}
+
+// `count` units of `unit` (statements, lines) went into `text`.
+static void report(const std::string &name, const std::string &text, size_t count, const char *unit)
+{
+    size_t statements = 0;
+    size_t errors = 0;
+    double milliseconds = timeParse(text, statements, errors);
+    std::cout << name << ": " << text.size() << " bytes, " << statements << " statements, " << errors << " errors, "
+              << milliseconds << " ms";
+    if (count > 0)
+        std::cout << " (" << milliseconds * 1e6 / count << " ns/" << unit << ")";
+    std::cout << std::endl;
+}
+
+static bool writeInput(const std::string &path, const std::string &text)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty())
+    {
+        std::cerr << "usage: parsebench scaling|malformed [count...] | <file>" << std::endl;
+        return 1;
+    }
+
+    if (args[0] == "scaling" || args[0] == "malformed")
+    {
+        bool scaling = args[0] == "scaling";
+        std::string (*generate)(size_t) = scaling ? wellFormedStatements : malformedLines;
+        if (args.size() == 4 && args[1] == "--write")
+            return writeInput(args[2], generate(std::strtoul(args[3].c_str(), nullptr, 10))) ? 0 : 1;
+
+        std::vector<size_t> counts;
+        for (size_t i = 1; i < args.size(); i++)
+            counts.push_back(std::strtoul(args[i].c_str(), nullptr, 10));
+        if (counts.empty())
+            counts = scaling ? std::vector<size_t>{10000, 100000, 1000000} : std::vector<size_t>{300000};
+
+        for (size_t count : counts)
+            report(std::to_string(count) + (scaling ? " statements" : " malformed lines"), generate(count), count,
+                   scaling ? "stmt" : "line");
+        return 0;
+    }
+
+    std::ifstream file(args[0], std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "File read failed: " << args[0] << std::endl;
+        return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    report(args[0], text, static_cast<size_t>(std::count(text.begin(), text.end(), '\n')), "line");
+    return 0;
+}